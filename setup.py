@@ -1,27 +1,51 @@
 from distutils.core import setup, Extension
+import os
 import sys
 import numpy
 
+# set HEXARIO_HEADLESS=1 to build without SDL2. The headless build
+# only supports feature observations and cannot show the game.
+headless = os.environ.get('HEXARIO_HEADLESS', '0') not in ('', '0')
+
 # compile the c++ extension
 _sources = [
     'player.cc',
     'board.cc',
     'game.cc',
-    'renderer.cc',
     'controller.cc',
+    'vector_controller.cc',
+    'bots.cc',
+    'mcts.cc',
     'utils.cc',
+    'thread_pool.cc',
     'py_module.cc'
 ]
+
+if not headless:
+    _sources += ['renderer.cc', 'recorder.cc']
+
+# the shared memory environment server needs POSIX
+if sys.platform != 'win32':
+    _sources += ['env_server.cc']
+
 sources = ["src/src_cpp/" + filename for filename in _sources]
-sources += [
-    'src/SDL2_gfx-1.0.4/SDL2_gfxPrimitives.c'
-]
+
+if not headless:
+    sources += [
+        'src/SDL2_gfx-1.0.4/SDL2_gfxPrimitives.c'
+    ]
 
 if sys.platform == 'win32':
     library_dirs = []
 else:
     library_dirs = ['~/lib', '/usr/local/lib', 'usr/lib']
 
+libraries = [] if headless else ['SDL2']
+
+# shm_open lives in librt on older glibc
+if sys.platform.startswith('linux'):
+    libraries += ['rt']
+
 module1 = Extension('gym_hexario.game_module',
                     language='c++',
                     include_dirs=[
@@ -29,7 +53,8 @@ module1 = Extension('gym_hexario.game_module',
                         'src/SDL2_gfx-1.0.4/',
                         numpy.get_include()],
 
-                    libraries=['SDL2'],
+                    define_macros=[('HEXARIO_HEADLESS', None)] if headless else [],
+                    libraries=libraries,
                     library_dirs=library_dirs,
                     sources=sources)
 
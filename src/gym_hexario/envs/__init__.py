@@ -1,3 +1,5 @@
 """Hexario Gym Environment"""
 
-from .hexario_env import HexarioEnv
\ No newline at end of file
+from .hexario_env import HexarioEnv, unpack_action_masks
+from .hexario_vector_env import HexarioVectorEnv
+from .hexario_server_env import HexarioServerVectorEnv
@@ -12,40 +12,113 @@ FEATURES = 'features'
 PIXEL = 'pixels'
 FULL = 'full'
 
+# fields of the info returned by step, combine them with |
+INFO_KILLS = game_module.INFO_KILLS
+INFO_CAPTURES = game_module.INFO_CAPTURES
+INFO_CLAIMS = game_module.INFO_CLAIMS
+INFO_COVERAGE = game_module.INFO_COVERAGE
+INFO_WINNER = game_module.INFO_WINNER
+INFO_DEAD = game_module.INFO_DEAD
+INFO_DISTANCES = game_module.INFO_DISTANCES
+INFO_STEPS = game_module.INFO_STEPS
+INFO_RESET = game_module.INFO_RESET
+INFO_ALL = game_module.INFO_ALL
+
+# types of the records returned by events: the meaning of player, other and value
+EVENT_CLAIMED = game_module.EVENT_CLAIMED       # player claimed the tile (q, r)
+EVENT_CAPTURED = game_module.EVENT_CAPTURED     # player captured value tiles of other, -1 for free tiles
+EVENT_KILLED = game_module.EVENT_KILLED         # player killed other, value is one of the CAUSES
+EVENT_DIED = game_module.EVENT_DIED             # player died without a killer, value is the cause
+EVENT_WON = game_module.EVENT_WON               # player captured the whole map
+
+# causes of killed and died events
+CAUSES = {
+    game_module.CAUSE_HEAD: 'head',             # both heads on the same tile
+    game_module.CAUSE_SWAP: 'swap',             # heads swapped their tiles
+    game_module.CAUSE_TAIL: 'tail',             # head on the trail
+    game_module.CAUSE_SURROUNDED: 'surrounded', # whole territory captured
+    game_module.CAUSE_BORDER: 'border',         # head on the border
+    game_module.CAUSE_SPAWN: 'spawn',           # whole territory taken by a respawn
+}
+
+# native opponents, see the opponents parameter of HexarioEnv
+BOTS = {
+    'random': game_module.BOT_RANDOM,           # moves randomly, but never onto the border
+    'grabber': game_module.BOT_GRABBER,         # grabs territory in loops
+    'hunter': game_module.BOT_HUNTER,           # chases the claims of other players
+    'defensive': game_module.BOT_DEFENSIVE,     # small loops, retreats when others come close
+}
+
+
+def unpack_action_masks(masks):
+    """ turns 6 bit action masks, e.g. from action_masks, into bool arrays of shape (..., 6) """
+    masks = np.asarray(masks, dtype=np.uint8)
+    return np.unpackbits(masks[..., None], axis=-1, count=6, bitorder='little').astype(bool)
+
 
 class HexarioEnv(gym.Env):
     def __init__(self,
                  n_agents=1,
                  n_random_agents=0,
+                 opponents=(),
                  map_radius=10,
                  max_steps=500,
                  perspective=LOCAL,
                  observation_space=FEATURES,
                  observation_radius=5,
                  px_observation_dims=(84, 84),
+                 px_supersampling=1,
+                 render_threads=1,
+                 shared_global_render=False,
                  action_space=DISCRETE,
                  velocity=0.1,
+                 headings=0,
                  reward_timestep=0,
                  reward_capture=1,
                  reward_claim=0,
-                 reward_kill=100):
+                 reward_kill=100,
+                 info_fields=INFO_ALL,
+                 auto_reset=False,
+                 seed=None):
         """
         OpenAI gym environment for the game Hexar.io
 
         :param n_agents:                        number of agents
         :param n_random_agents:                 number of random agents. These are environment internal and cannot be
                                                 controlled
+        :param opponents:                       further environment internal opponents, a list of BOTS names,
+                                                e.g. ['grabber', 'hunter']. They are stepped natively
         :param map_radius:                      size of the arena
         :param max_steps:                       maximum number of steps the agents are allowed to take in one epoch
         :param perspective                      [local|global]
         :param observation_space:               [features|pixel]
         :param observation_radius:
         :param px_observation_dims:
+        :param px_supersampling:                render pixel observations at px_supersampling times the
+                                                resolution and area average them down to px_observation_dims
+        :param render_threads:                  number of threads used to generate the observations of
+                                                multiple agents in parallel
+        :param shared_global_render:            with global pixel observations, render the board only once
+                                                per step and colour it for each agent
         :param action_space:                    [discrete|continuous]
+        :param velocity:                        distance moved per step with the continuous action space.
+                                                Longer moves are checked in substeps of at most half a tile,
+                                                so no tiles are skipped
+        :param headings:                        with the continuous action space, round the angles to this many
+                                                evenly spaced headings and move in fixed point, which is
+                                                faster and exactly reproducible. A multiple of 6 contains the
+                                                6 tile directions. 0 moves along any angle
         :param reward_timestep:
         :param reward_capture:
         :param reward_claim:
         :param reward_kill:
+        :param info_fields:                     fields of the info dict, e.g. INFO_KILLS | INFO_CAPTURES.
+                                                Fields which are not requested are not computed
+        :param auto_reset:                      respawn agents within step as soon as they are done. The returned
+                                                observation is the first one of the new episode and
+                                                info['reset'] is set, there is no need to call reset
+        :param seed:                            seed of the game's random numbers (spawn points, opponents),
+                                                None for a random one
         """
 
         # do some integrity checks
@@ -53,6 +126,8 @@ class HexarioEnv(gym.Env):
             n_agents, int), f'invalid value for parameter n_agents: {n_agents}'
         assert n_random_agents >= 0 and isinstance(
             n_random_agents, int), f'invalid value for parameter n_random_agents: {n_random_agents}'
+        assert all(opponent in BOTS for opponent in opponents), \
+            f'invalid value for parameter opponents: {opponents}'
         assert map_radius > 2 and isinstance(
             map_radius, int), f'invalid value for parameter map_radius: {map_radius}'
         assert max_steps > 0 and isinstance(
@@ -67,25 +142,38 @@ class HexarioEnv(gym.Env):
             DISCRETE, CONTINUOUS), f'invalid value for parameter action_space: {action_space}'
         assert isinstance(px_observation_dims, tuple) and len(px_observation_dims) == 2, \
             f'invalid value for parameter pixel_observation_dimensions: {px_observation_dims}'
+        assert isinstance(px_supersampling, int) and px_supersampling >= 1, \
+            f'invalid value for parameter px_supersampling: {px_supersampling}'
+        assert isinstance(render_threads, int) and render_threads >= 1, \
+            f'invalid value for parameter render_threads: {render_threads}'
+        assert isinstance(info_fields, int) and 0 <= info_fields <= INFO_ALL, \
+            f'invalid value for parameter info_fields: {info_fields}'
         assert not (observation_space == FEATURES and action_space == CONTINUOUS), \
             f'invalid parameters: feature observation space and continuous action space are incompatible'
 
         # TODO maybe find a nice way to implement this
         # TODO the question is when to reset the agents
-        assert n_agents == 1 or n_random_agents == 0, \
+        assert n_agents == 1 or (n_random_agents == 0 and len(opponents) == 0), \
             f'currently, multiple agents with multiple random agents is not supported!'
 
-        assert isinstance(velocity, float) and velocity > 0 and velocity <= 1, \
+        assert isinstance(velocity, float) and velocity > 0, \
             f'invalid parameter velocity: {velocity}'
+        assert isinstance(headings, int) and headings >= 0, \
+            f'invalid parameter headings: {headings}'
 
         self.n_agents = n_agents
         self.n_random_agents = n_random_agents
+        self.opponents = ['random'] * n_random_agents + list(opponents)
         self.map_radius = map_radius
         self.max_steps = max_steps
         self.perspective = perspective
         self.observation_radius = 2 * self.map_radius if observation_radius == FULL else observation_radius
         self.px_observation_dims = px_observation_dims
+        self.px_supersampling = px_supersampling
+        self.render_threads = render_threads
+        self.shared_global_render = shared_global_render
         self.velocity = velocity
+        self.headings = headings
 
         # these variable names should not be used because they are for gym en
         self.observation_type = observation_space
@@ -95,11 +183,10 @@ class HexarioEnv(gym.Env):
         self.reward_capture = reward_capture
         self.reward_claim = reward_claim
         self.reward_kill = reward_kill
+        self.info_fields = info_fields
+        self.auto_reset = auto_reset
 
         self.max_capture = self.__get_num_tiles()
-        # keep track of the number of steps the agents already
-        # have taken. Reset an agent when it has reached the max_steps
-        self.__taken_steps = [0 for _ in range(n_agents)]
 
         # check the action spaces
         if self.action_type == DISCRETE:
@@ -140,22 +227,143 @@ class HexarioEnv(gym.Env):
 
         # access layer for the c++ implementation
         self.__game = game_module.setup(self.map_radius,
-                                        self.n_agents + self.n_random_agents,
+                                        self.n_agents + len(self.opponents),
                                         self.perspective == LOCAL,
                                         self.observation_type == FEATURES,
                                         self.action_type == DISCRETE,
                                         self.observation_radius,
                                         self.px_observation_dims[0],
                                         self.px_observation_dims[1],
-                                        self.velocity)
+                                        self.velocity,
+                                        px_supersampling=self.px_supersampling,
+                                        render_threads=self.render_threads,
+                                        shared_global_render=self.shared_global_render,
+                                        reward_timestep=self.reward_timestep,
+                                        reward_capture=self.reward_capture,
+                                        reward_claim=self.reward_claim,
+                                        reward_kill=self.reward_kill,
+                                        max_steps=self.max_steps,
+                                        auto_reset=self.auto_reset,
+                                        seed=seed,
+                                        headings=self.headings,
+                                        bots=[game_module.BOT_NONE] * self.n_agents +
+                                             [BOTS[opponent] for opponent in self.opponents])
+
+        # the bots replace their entries of the actions array
+        self.__actions = np.zeros(self.n_agents + len(self.opponents),
+                                  dtype=np.int64 if self.action_type == DISCRETE else np.float32)
+        self.__search = None
 
     def __del__(self):
+        self.__search = None
         del self.__game
 
+    def seed(self, seed=None):
+        """ seeds the game's random numbers, the following episodes only depend on the seed and the actions """
+        game_module.seed(self.__game, seed)
+        return [seed]
+
+    def action_masks(self):
+        """
+        6 bit masks of the discrete actions of every agent, bit i for action i (see unpack_action_masks).
+        safe: the actions which do not run onto the border, the only move which kills for sure.
+        danger: the actions where another head may collide with the agent in the next step, all
+        actions if another head can reach its trail.
+
+        :return:                                (safe, danger), arrays of shape (n_agents,) or
+                                                single values for one agent
+        """
+        safe, danger = game_module.get_action_masks(self.__game, self.n_agents)
+
+        if self.n_agents == 1:
+            return safe[0], danger[0]
+
+        return safe, danger
+
+    def events(self):
+        """
+        what happened in the last step (and the respawns after it) as structured array with
+        the fields type, player, other, value, q and r, see the EVENT_* types. Ordered by
+        cause, e.g. a kill by a capture comes before the capture. Rewards or logs can be
+        computed from it without querying every player.
+        """
+        return game_module.get_events(self.__game)
+
+    def snapshot(self):
+        """ returns the state of the game as bytes, e.g. to try several actions from the same state """
+        return game_module.snapshot(self.__game)
+
+    def restore(self, snapshot):
+        """ sets the game back to a snapshot of an env with the same configuration """
+        game_module.restore(self.__game, snapshot)
+
+    def setup_search(self, num_threads=1, rollout='random', rollout_depth=20, discount=0.99, exploration=1.4,
+                     virtual_loss=1., batch_size=16, seed=None):
+        """
+        configures the native Monte Carlo tree search used by search, only for the discrete action space.
+        The workers search the shared tree in parallel, a virtual loss keeps them on different paths.
+
+        :param num_threads:                     number of search threads, each one steps its own copy of the game
+        :param rollout:                         name of the BOTS policy which steps the agents in rollouts
+        :param rollout_depth:                   maximum number of steps of a rollout from a new leaf
+        :param discount:                        discount of the rewards
+        :param exploration:                     exploration constant of UCT
+        :param virtual_loss:                    value subtracted from a node while a simulation runs through it
+        :param batch_size:                      number of leaves passed to evaluate at once
+        :param seed:                            seed of the tie breaking, None for a random one
+        """
+        assert rollout in BOTS, f'invalid value for parameter rollout: {rollout}'
+
+        self.__search = game_module.setup_mcts(self.__game, num_threads=num_threads, rollout=BOTS[rollout],
+                                               rollout_depth=rollout_depth, discount=discount,
+                                               exploration=exploration, virtual_loss=virtual_loss,
+                                               batch_size=batch_size, seed=seed)
+
+    def search(self, num_simulations, agent_id=0, evaluate=None):
+        """
+        searches the actions of an agent from the current state, the game itself is not changed.
+
+        :param num_simulations:                 number of simulations
+        :param agent_id:                        the searching agent
+        :param evaluate:                        optional function from a batch of observations to their values,
+                                                e.g. a value network. Its value of the state at the end of a
+                                                rollout is added to the discounted rollout rewards
+        :return:                                (visits, values) of the 6 actions
+        """
+        if self.__search is None:
+            self.setup_search()
+
+        evaluate_flat = None
+        if evaluate is not None:
+            shape = self.observation_space.shape
+            evaluate_flat = lambda observations: evaluate(observations.reshape(-1, *shape))
+
+        return game_module.mcts_search(self.__search, agent_id, num_simulations, evaluate=evaluate_flat)
+
     def render(self, mode='human'):
         """displays the whole board on screen"""
         return game_module.show(self.__game)
 
+    def start_recording(self, path, video_format='y4m', dims=(400, 400), queue_size=64):
+        """
+        records the whole board after every step without opening a window.
+        The frames are written by a background thread, frames are dropped if it falls behind.
+
+        :param path:            file name of the video for 'y4m', file name prefix for 'ppm'
+        :param video_format:    [y4m|ppm]
+        :param dims:            (width, height) of the frames
+        :param queue_size:      number of frames that may wait to be written
+        """
+        game_module.start_recording(self.__game, path, format=video_format, width=dims[0], height=dims[1],
+                                    queue_size=queue_size)
+
+    def stop_recording(self):
+        """
+        finishes the recording
+        :return: (number of written frames, number of dropped frames) or None if nothing was recorded
+        """
+        return game_module.stop_recording(self.__game)
+
     def reset(self, agents=None):
         """ gets overridden """
         raise NotImplemented
@@ -171,27 +379,29 @@ class HexarioEnv(gym.Env):
         """ gets overridden """
         raise NotImplementedError
 
-    def __reset_single_agent(self):
+    def __reset_single_agent(self, seed=None):
         """ """
-        self.__taken_steps[0] = 0
-        game_module.reset_player(self.__game, 0)
+        if seed is not None:
+            game_module.seed(self.__game, seed)
 
-        # reset the random agents
-        for agent_id in range(1, self.n_random_agents + 1):
-            game_module.reset_player(self.__game, agent_id)
+        # the agent and the opponents start on an empty board
+        game_module.reset_all(self.__game)
 
         return self.__get_observation(0)
 
-    def __reset_multi_agent(self, agents=()):
+    def __reset_multi_agent(self, agents=(), seed=None):
         """ """
         n_obs = []
 
+        if seed is not None:
+            game_module.seed(self.__game, seed)
+
         if agents == 'all':
             agents = [i for i in range(self.n_agents)]
-
-        for agent_id in agents:
-            self.__taken_steps[agent_id] = 0
-            game_module.reset_player(self.__game, agent_id)
+            game_module.reset_all(self.__game)
+        else:
+            for agent_id in agents:
+                game_module.reset_player(self.__game, agent_id)
 
         # TODO what happens to the random agents?
 
@@ -202,57 +412,25 @@ class HexarioEnv(gym.Env):
 
     def __step_single_agent(self, action):
         """ """
-        actions = np.array([action], dtype=np.float32).flatten()
+        # discrete actions keep their integer dtype, the game reads them in place
+        actions = np.array([action]).flatten()
         assert len(actions) == 1
 
-        reward = self.reward_timestep
+        if self.opponents:
+            # the opponents act natively
+            self.__actions[0] = actions[0]
+            actions = self.__actions
 
-        captures_before = game_module.get_num_captures(self.__game, 0)
-        claims_before = game_module.get_num_claims(self.__game, 0)
-        kills_before = game_module.get_num_kills(self.__game, 0)
+        # rewards and dones are computed natively, the opponents need the dead flags
+        info_fields = self.info_fields | (INFO_DEAD if self.opponents else 0)
+        observations, rewards, dones, n_info = game_module.step(self.__game, actions, 1, info_fields=info_fields)
 
-        if self.n_random_agents > 0:
-            # decide the actions for the random agents
-            actions = np.concatenate([actions,
-                                     [self.__get_random_agent_action(i) for i in range(1, self.n_random_agents + 1)]])
-            actions = actions.flatten().astype(np.float32)
-
-        game_module.take_actions(self.__game, actions)
-        self.__taken_steps[0] += 1
-
-        # check which players are still in the game
-        dones = [game_module.is_dead(self.__game, i) for i in range(1 + self.n_random_agents)]
-        is_dead = dones[0]
-        is_winner = game_module.is_winner(self.__game, 0)
-        captures_after = game_module.get_num_captures(self.__game, 0)
-        claims_after = game_module.get_num_claims(self.__game, 0)
-        kills_after = game_module.get_num_kills(self.__game, 0)
+        info = self.__get_info(n_info, 0)
 
         # check if the agent is the last one alive
-        all_others_dead = True
-        if self.n_random_agents > 0:
-            all_others_dead = False not in dones[1:]
-
-        if not is_dead:
-            reward += self.reward_capture * (captures_after - captures_before)
-            reward += self.reward_claim * max(claims_after - claims_before, 0)
-            reward += self.reward_kill * max(kills_after - kills_before, 0)
-
-        info = dict(
-            num_kills=kills_after,
-            num_captures=captures_after,
-            num_claims=claims_after,
-            coverage=captures_after / self.max_capture,
-            success=is_winner,
-            distances=game_module.get_distances(self.__game, 0),
-            all_others_dead=all_others_dead
-        )
-
-        done = is_dead or is_winner or (
-            self.__taken_steps[0] == self.max_steps)
-        observation = self.__get_observation(0)
-
-        return observation, reward, done, info
+        info['all_others_dead'] = bool(n_info['dead'][1:].all()) if self.opponents else True
+
+        return self.__shape_observation(observations[0]), float(rewards[0]), bool(dones[0]), info
 
     def __step_multi_agent(self, actions):
         """ an action must be passed for every agent """
@@ -260,69 +438,35 @@ class HexarioEnv(gym.Env):
             given actions doesn't match number of agents in this game"
 
         if isinstance(actions, list):
-            actions = np.array(actions, dtype=np.float32)
+            actions = np.array(actions)
 
         assert isinstance(actions, np.ndarray), "Error: given actions \
             are in the wrong format"
 
-        actions = actions.flatten()
+        # rewards, dones and the observations of all agents are generated in one call
+        observations, rewards, dones, n_info = game_module.step(self.__game, actions.flatten(), self.n_agents,
+                                                                info_fields=self.info_fields)
 
-        n_obs = []
-        n_kills = []
-        n_claims = []
-        n_captures = []
-        n_dones = []
-        n_rewards = []
-        n_infos = []
-
-        # cache all the kills and captures
-        for agent_id in range(self.n_agents):
-            n_kills.append(game_module.get_num_kills(self.__game, agent_id))
-            n_claims.append(game_module.get_num_claims(self.__game, agent_id))
-            n_captures.append(
-                game_module.get_num_captures(self.__game, agent_id))
-
-        # take all the actions
-        game_module.take_actions(self.__game, actions)
-
-        # get the dones, kills, observations
-        for agent_id in range(self.n_agents):
-            self.__taken_steps[agent_id] += 1
-            reward = self.reward_timestep
-
-            is_dead = game_module.is_dead(self.__game, agent_id)
-            is_winner = game_module.is_winner(self.__game, 0)
-
-            kills = game_module.get_num_kills(self.__game, agent_id)
-            claims = game_module.get_num_claims(self.__game, agent_id)
-            captures = game_module.get_num_captures(self.__game, agent_id)
-
-            if not is_dead:
-                reward += self.reward_capture * \
-                    (captures - n_captures[agent_id])
-                reward += self.reward_claim * \
-                    (claims - n_claims[agent_id])
-                reward += self.reward_kill * (kills - n_kills[agent_id])
-
-            info = dict(
-                num_kills=kills,
-                num_captures=captures,
-                num_claims=claims,
-                coverage=captures / self.max_capture,
-                success=is_winner,
-                distances=game_module.get_distances(self.__game, agent_id)
-            )
-
-            done = is_dead or is_winner or (
-                self.__taken_steps[agent_id] == self.max_steps)
-            obs = game_module.get_observation(self.__game, agent_id)
-
-            n_dones.append(done)
-            n_rewards.append(reward)
-            n_obs.append(obs)
-            n_infos.append(info)
-
-        return n_obs, n_rewards, n_dones, n_infos
+        n_obs = [self.__shape_observation(observation) for observation in observations]
+        n_infos = [self.__get_info(n_info, agent_id) for agent_id in range(self.n_agents)]
+
+        return n_obs, rewards.tolist(), dones.tolist(), n_infos
+
+    def __get_info(self, n_info, agent_id):
+        """ info dict of one agent from the info records returned by game_module.step """
+        info = n_info[agent_id].tolist()
+
+        # tolist turns the record into a tuple, the distances stay an array
+        return {name: tuple(value.tolist()) if name == 'distances' else value
+                for name, value in zip(n_info.dtype.names, info)}
+
+    def __shape_observation(self, observation):
+        if self.observation_type == PIXEL:
+            return observation.reshape(
+                self.px_observation_dims[1],
+                self.px_observation_dims[0], 3)
+
+        return observation
 
     def __get_discrete_observation(self, agent_id):
         """ """
@@ -335,11 +479,3 @@ class HexarioEnv(gym.Env):
         return observation.reshape(
             self.px_observation_dims[1],
             self.px_observation_dims[0], 3)
-
-    def __get_random_agent_action(self, random_agent_id):
-
-        distances = game_module.get_distances(self.__game, random_agent_id)
-        probs = np.array([1 if d > 1 else 0 for d in distances], dtype=np.float32)
-        probs = probs / sum(probs)
-        action = np.random.choice([0, 1, 2, 3, 4, 5], 1, p=probs)
-        return action[0]
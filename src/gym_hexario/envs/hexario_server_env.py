@@ -0,0 +1,246 @@
+import os
+import time
+import shutil
+import socket
+import struct
+import tempfile
+import multiprocessing as mp
+from multiprocessing import shared_memory
+import numpy as np
+from gym import spaces
+import gym_hexario.game_module as game_module
+from gym_hexario.envs.hexario_env import DISCRETE, FEATURES, INFO_ALL
+
+# see env_server.h
+SERVER_RESET = 0
+SERVER_STEP = 1
+SERVER_CLOSE = 2
+SERVER_OK = 0
+SERVER_MAGIC = 0x6865786172696f31
+
+_MESSAGE = struct.Struct('=ii')
+_LAYOUT = struct.Struct('=14q')
+
+
+def _serve(socket_path, shm_name, num_envs, env_offset, num_slots, kwargs):
+    """ runs in a worker process """
+    from gym_hexario.envs.hexario_vector_env import HexarioVectorEnv
+
+    envs = HexarioVectorEnv(**kwargs)
+    envs.serve(socket_path, shm_name, num_envs, env_offset, num_slots)
+
+
+class HexarioServerVectorEnv:
+    def __init__(self, num_workers, envs_per_worker, num_slots=2, start_timeout=60, **kwargs):
+        """
+        batch of num_workers * envs_per_worker games, spread over worker processes.
+        Every worker runs a HexarioVectorEnv of envs_per_worker games and serves it through
+        a shared memory segment: the actions are written to and the results are read from
+        the segment, only the commands go through a unix socket per worker.
+
+        The returned arrays are views of the segment, each step writes to the next of
+        num_slots slots. The results of a step are valid until num_slots - 1 further steps,
+        copy them if they are needed longer.
+
+        :param num_workers:                     number of worker processes
+        :param envs_per_worker:                 number of games of each worker
+        :param num_slots:                       number of steps whose results are kept
+        :param start_timeout:                   seconds to wait for the workers to start
+        :param kwargs:                          passed to HexarioVectorEnv in every worker
+        """
+        self.__processes = []
+        self.__sockets = []
+        self.__slots = []
+        self.__shm = None
+        self.__shm_name = None
+        self.__directory = None
+
+        assert num_workers > 0 and isinstance(
+            num_workers, int), f'invalid value for parameter num_workers: {num_workers}'
+        assert envs_per_worker > 0 and isinstance(
+            envs_per_worker, int), f'invalid value for parameter envs_per_worker: {envs_per_worker}'
+        assert num_slots > 0 and isinstance(
+            num_slots, int), f'invalid value for parameter num_slots: {num_slots}'
+
+        self.num_workers = num_workers
+        self.num_envs = num_workers * envs_per_worker
+        self.n_agents = kwargs.get('n_agents', 1)
+        self.num_slots = num_slots
+        self.__slot = 0
+
+        if kwargs.get('action_space', DISCRETE) == DISCRETE:
+            self.action_space = spaces.Discrete(6)
+        else:
+            self.action_space = spaces.Box(low=0., high=2 * np.pi, shape=(1,))
+
+        kwargs = dict(kwargs, num_envs=envs_per_worker)
+        info_fields = kwargs.get('info_fields', INFO_ALL)
+
+        self.__directory = tempfile.mkdtemp(prefix='hexario_')
+        self.__shm_name = f'hexario_{os.getpid()}_{id(self):x}'
+
+        try:
+            context = mp.get_context('spawn')
+
+            for worker in range(num_workers):
+                socket_path = os.path.join(self.__directory, f'worker{worker}.sock')
+                worker_kwargs = kwargs
+
+                # environment i is seeded with seed + i, like in a single HexarioVectorEnv
+                if kwargs.get('seed') is not None:
+                    worker_kwargs = dict(kwargs, seed=kwargs['seed'] + worker * envs_per_worker)
+
+                process = context.Process(target=_serve, daemon=True,
+                                          args=(socket_path, '/' + self.__shm_name, self.num_envs,
+                                                worker * envs_per_worker, num_slots, worker_kwargs))
+                process.start()
+                self.__processes.append((process, socket_path))
+
+            deadline = time.monotonic() + start_timeout
+            for process, socket_path in self.__processes:
+                self.__sockets.append(self.__connect(process, socket_path, deadline))
+
+            # every worker has sized the segment before it listens
+            self.__shm = shared_memory.SharedMemory(name=self.__shm_name)
+            self.__map_slots(kwargs, info_fields)
+        except BaseException:
+            self.close()
+            raise
+
+    def __del__(self):
+        self.close()
+
+    @staticmethod
+    def __connect(process, socket_path, deadline):
+        while True:
+            try:
+                connection = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+                connection.connect(socket_path)
+                return connection
+            except (FileNotFoundError, ConnectionRefusedError):
+                connection.close()
+
+                if not process.is_alive():
+                    raise RuntimeError(f'environment worker exited with code {process.exitcode}')
+                if time.monotonic() > deadline:
+                    raise TimeoutError('environment worker did not start in time')
+
+                time.sleep(0.01)
+
+    def __map_slots(self, kwargs, info_fields):
+        (magic, num_slots, num_envs, n_agents, observation_size, _, info_record_size, slots_offset, slot_size,
+         actions_offset, observations_offset, rewards_offset, dones_offset, info_offset) = \
+            _LAYOUT.unpack_from(self.__shm.buf)
+
+        assert magic == SERVER_MAGIC and num_slots == self.num_slots and num_envs == self.num_envs, \
+            'unexpected layout of the shared memory'
+
+        if kwargs.get('observation_space', FEATURES) == FEATURES:
+            self.obs_shape = (observation_size,)
+            self.observation_space = spaces.Box(low=0., high=10., shape=self.obs_shape, dtype=np.float32)
+        else:
+            dims = kwargs.get('px_observation_dims', (84, 84))
+            self.obs_shape = (dims[1], dims[0], 3)
+            self.observation_space = spaces.Box(low=0, high=255, dtype=np.float32, shape=(*dims, 3))
+
+        info_dtype = game_module.info_dtype(info_fields)
+        assert info_dtype.itemsize == info_record_size
+
+        shape = (num_envs,) if n_agents == 1 else (num_envs, n_agents)
+        count = num_envs * n_agents
+
+        def view(slot, offset, dtype, entry_shape=()):
+            return np.ndarray((*shape, *entry_shape), dtype=dtype, buffer=self.__shm.buf,
+                              offset=slots_offset + slot * slot_size + offset)
+
+        self.__slots = [(view(slot, actions_offset, np.float32),
+                         view(slot, observations_offset, np.float32, self.obs_shape),
+                         view(slot, rewards_offset, np.float32),
+                         view(slot, dones_offset, np.bool_),
+                         view(slot, info_offset, info_dtype))
+                        for slot in range(num_slots)]
+        assert count * observation_size == self.__slots[0][1].size
+
+    def __send(self, command, slot):
+        message = _MESSAGE.pack(command, slot)
+
+        # all workers run the command in parallel, the replies are collected by __receive
+        for connection in self.__sockets:
+            connection.sendall(message)
+
+    def __receive(self):
+        for connection in self.__sockets:
+            reply = b''
+            while len(reply) < _MESSAGE.size:
+                chunk = connection.recv(_MESSAGE.size - len(reply))
+                if not chunk:
+                    raise RuntimeError('environment worker disconnected')
+                reply += chunk
+
+            status, _ = _MESSAGE.unpack(reply)
+            if status != SERVER_OK:
+                raise RuntimeError('environment worker failed to run a command')
+
+    def reset(self):
+        """ respawns all agents of all games """
+        self.__slot = (self.__slot + 1) % self.num_slots
+        self.__send(SERVER_RESET, self.__slot)
+        self.__receive()
+        return self.__slots[self.__slot][1]
+
+    def step(self, actions):
+        """ same as HexarioVectorEnv.step, the results are views of the shared memory """
+        self.step_async(actions)
+        return self.step_wait()
+
+    def step_async(self, actions):
+        """ starts the step in the workers and returns immediately, step_wait returns its results """
+        self.__slot = (self.__slot + 1) % self.num_slots
+        slot_actions = self.__slots[self.__slot][0]
+
+        slot_actions[...] = np.reshape(actions, slot_actions.shape)
+        self.__send(SERVER_STEP, self.__slot)
+
+    def step_wait(self):
+        """ waits for the step started by step_async """
+        self.__receive()
+        return self.__slots[self.__slot][1:]
+
+    def close(self):
+        """ stops the workers and frees the shared memory """
+        for connection in self.__sockets:
+            try:
+                connection.sendall(_MESSAGE.pack(SERVER_CLOSE, 0))
+            except OSError:
+                pass
+            connection.close()
+        self.__sockets = []
+
+        for process, _ in self.__processes:
+            process.join(timeout=10)
+            if process.is_alive():
+                process.terminate()
+        self.__processes = []
+
+        self.__slots = []
+
+        if self.__shm is None and self.__shm_name is not None:
+            # the workers may have created the segment before the start failed
+            try:
+                self.__shm = shared_memory.SharedMemory(name=self.__shm_name)
+            except FileNotFoundError:
+                pass
+
+        if self.__shm is not None:
+            self.__shm.unlink()
+            try:
+                self.__shm.close()
+            except BufferError:
+                # returned arrays are still in use, the memory is freed with them
+                pass
+            self.__shm = None
+        self.__shm_name = None
+
+        if self.__directory is not None:
+            shutil.rmtree(self.__directory, ignore_errors=True)
+            self.__directory = None
@@ -0,0 +1,195 @@
+import numpy as np
+from gym import spaces
+import gym_hexario.game_module as game_module
+from gym_hexario.envs.hexario_env import LOCAL, GLOBAL, DISCRETE, CONTINUOUS, FEATURES, PIXEL, FULL, INFO_ALL
+
+
+class HexarioVectorEnv:
+    def __init__(self,
+                 num_envs,
+                 n_agents=1,
+                 map_radius=10,
+                 max_steps=500,
+                 perspective=LOCAL,
+                 observation_space=FEATURES,
+                 observation_radius=5,
+                 px_observation_dims=(84, 84),
+                 px_supersampling=1,
+                 shared_global_render=False,
+                 action_space=DISCRETE,
+                 velocity=0.1,
+                 headings=0,
+                 reward_timestep=0,
+                 reward_capture=1,
+                 reward_claim=0,
+                 reward_kill=100,
+                 num_threads=1,
+                 pin_threads=False,
+                 info_fields=INFO_ALL,
+                 reuse_buffers=False,
+                 seed=None):
+        """
+        batch of num_envs independent Hexar.io games, stepped by a single native call.
+        Agents which are done are respawned automatically, the observation returned for
+        them is the first one of their new episode.
+
+        Arrays have the shape (num_envs, n_agents, ...), the agent axis is dropped for n_agents == 1.
+        info is a structured array with the fields selected by info_fields.
+        The remaining parameters are the same as for HexarioEnv.
+
+        :param num_envs:                        number of games
+        :param num_threads:                     number of threads the games are spread over
+        :param pin_threads:                     bind every worker thread to its own core
+        :param reuse_buffers:                   write every step to the arrays returned by the previous one,
+                                                so stepping allocates no memory. The previous results are
+                                                overwritten, copy them if they are needed later
+        :param seed:                            the game of environment i is seeded with seed + i,
+                                                None for a random seed
+        """
+        assert num_envs > 0 and isinstance(
+            num_envs, int), f'invalid value for parameter num_envs: {num_envs}'
+        assert n_agents > 0 and isinstance(
+            n_agents, int), f'invalid value for parameter n_agents: {n_agents}'
+        assert map_radius > 2 and isinstance(
+            map_radius, int), f'invalid value for parameter map_radius: {map_radius}'
+        assert num_threads > 0 and isinstance(
+            num_threads, int), f'invalid value for parameter num_threads: {num_threads}'
+        assert max_steps > 0 and isinstance(
+            max_steps, int), f'invalid value for parameter max_steps: {max_steps}'
+        assert observation_radius == FULL or (observation_radius > 1 and isinstance(observation_radius, int)), \
+            f'invalid argument observation_radius: {observation_radius}'
+        assert perspective in (
+            LOCAL, GLOBAL), f'invalid value for parameter perspective: {perspective}'
+        assert observation_space in (FEATURES, PIXEL), \
+            f'invalid value for parameter observation_space: {observation_space}'
+        assert action_space in (
+            DISCRETE, CONTINUOUS), f'invalid value for parameter action_space: {action_space}'
+        assert not (observation_space == FEATURES and action_space == CONTINUOUS), \
+            f'invalid parameters: feature observation space and continuous action space are incompatible'
+        assert isinstance(headings, int) and headings >= 0, \
+            f'invalid value for parameter headings: {headings}'
+
+        self.num_envs = num_envs
+        self.n_agents = n_agents
+        self.map_radius = map_radius
+        self.perspective = perspective
+        self.observation_radius = 2 * self.map_radius if observation_radius == FULL else observation_radius
+        self.px_observation_dims = px_observation_dims
+        self.observation_type = observation_space
+        self.action_type = action_space
+        self.info_fields = info_fields
+        self.reuse_buffers = reuse_buffers
+        self.__buffers = (None, None, None, None)
+
+        if self.action_type == DISCRETE:
+            self.action_space = spaces.Discrete(6)
+        else:
+            self.action_space = spaces.Box(low=0., high=2 * np.pi, shape=(1,))
+
+        if self.observation_type == FEATURES:
+            radius = self.observation_radius if self.perspective == LOCAL else self.map_radius
+            self.obs_shape = (1 + 3 * radius * (radius - 1),)
+            self.observation_space = spaces.Box(low=0., high=10., shape=self.obs_shape, dtype=np.float32)
+        else:
+            self.obs_shape = (self.px_observation_dims[1], self.px_observation_dims[0], 3)
+            self.observation_space = spaces.Box(low=0, high=255, dtype=np.float32,
+                                                shape=(*self.px_observation_dims, 3))
+
+        self.__game = game_module.setup_vector(num_envs,
+                                               self.map_radius,
+                                               self.n_agents,
+                                               self.perspective == LOCAL,
+                                               self.observation_type == FEATURES,
+                                               self.action_type == DISCRETE,
+                                               self.observation_radius,
+                                               self.px_observation_dims[0],
+                                               self.px_observation_dims[1],
+                                               velocity,
+                                               px_supersampling=px_supersampling,
+                                               shared_global_render=shared_global_render,
+                                               reward_timestep=reward_timestep,
+                                               reward_capture=reward_capture,
+                                               reward_claim=reward_claim,
+                                               reward_kill=reward_kill,
+                                               max_steps=max_steps,
+                                               num_threads=num_threads,
+                                               pin_threads=pin_threads,
+                                               seed=seed,
+                                               headings=headings)
+
+    def __del__(self):
+        del self.__game
+
+    def serve(self, socket_path, shm_name, num_envs, env_offset, num_slots=2):
+        """
+        serves the games to a HexarioServerVectorEnv in another process, they are the
+        games env_offset .. env_offset + self.num_envs - 1 of num_envs in the shared memory
+        segment shm_name. Blocks until the client disconnects.
+        """
+        game_module.serve(self.__game, socket_path, shm_name, num_envs, env_offset,
+                          info_fields=self.info_fields, num_slots=num_slots)
+
+    def reset(self, seed=None):
+        """ respawns all agents of all games, seeds them before if seed is given """
+        return self.__shape_observations(game_module.vector_reset(self.__game, seed=seed))
+
+    def step(self, actions):
+        """ actions must have the shape (num_envs, n_agents), or (num_envs,) for a single agent """
+        obs_out, rewards_out, dones_out, info_out = self.__buffers
+        result = game_module.vector_step(self.__game, actions,
+                                         info_fields=self.info_fields,
+                                         obs_out=obs_out,
+                                         rewards_out=rewards_out,
+                                         dones_out=dones_out,
+                                         info_out=info_out)
+        return self.__shape_result(result)
+
+    def step_async(self, actions):
+        """
+        starts the step in a background thread and returns immediately, step_wait returns
+        its results. actions must not be modified until then. Meanwhile the environments
+        cannot be used, but e.g. the actions of another HexarioVectorEnv can be computed.
+        """
+        obs_out, rewards_out, dones_out, info_out = self.__buffers
+        game_module.step_async(self.__game, actions,
+                               info_fields=self.info_fields,
+                               obs_out=obs_out,
+                               rewards_out=rewards_out,
+                               dones_out=dones_out,
+                               info_out=info_out)
+
+    def step_wait(self):
+        """ waits for the step started by step_async, returns the same as step """
+        return self.__shape_result(game_module.step_wait(self.__game))
+
+    def action_masks(self):
+        """ the action masks of all agents (see HexarioEnv.action_masks), shaped like the rewards """
+        safe, danger = game_module.vector_action_masks(self.__game)
+
+        if self.n_agents == 1:
+            return safe[:, 0], danger[:, 0]
+
+        return safe, danger
+
+    def events(self):
+        """ the events of the last step of all games (see HexarioEnv.events), the field env is the game """
+        return game_module.vector_events(self.__game)
+
+    def __shape_result(self, result):
+        if self.reuse_buffers:
+            self.__buffers = result
+
+        observations, rewards, dones, info = result
+
+        if self.n_agents == 1:
+            rewards = rewards[:, 0]
+            dones = dones[:, 0]
+            info = info[:, 0]
+
+        return self.__shape_observations(observations), rewards, dones, info
+
+    def __shape_observations(self, observations):
+        if self.n_agents == 1:
+            return observations.reshape(self.num_envs, *self.obs_shape)
+
+        return observations.reshape(self.num_envs, self.n_agents, *self.obs_shape)
@@ -1,5 +1,4 @@
 #include <iostream>
-#include <unordered_map>
 #include <unordered_set>
 #include <cmath>
 #include <cassert>
@@ -30,19 +29,81 @@ Map for radius = 3:
 
 */
 
-Board::Board(int radius) : radius(radius), numTiles(1 + 3 * radius * (radius - 1)) 
+Board::Board(int radius) : 
+    radius(radius), 
+    numTiles(1 + 3 * radius * (radius - 1)),
+    width(2 * radius + 1),
+    owners(width * width, FREE_TILE),
+    numBlocking(width * width, 0),
+    freeSpawnIndex(width * width, -1),
+    clearanceArea(hexArea(CENTER, SPAWN_CLEARANCE + 1))
 {
+    for (int i = 0; i < width * width; i++) {
+        if (hexDistance(CENTER, tileAt(i)) <= radius - 3) {
+            spawnCenters.push_back(i);
+        }
+    }
+
     reset();
 }
 
+bool Board::contains(Tile t)
+{
+    return t.q >= -radius && t.q <= radius && t.r >= -radius && t.r <= radius;
+}
+
+int Board::index(Tile t)
+{
+    return (t.q + radius) * width + (t.r + radius);
+}
+
+Tile Board::tileAt(int index)
+{
+    return Tile{index / width - radius, index % width - radius};
+}
+
 /**
  * delete all tiles and set up the border again
  */
 void Board::reset()
 {
-    tiles.clear();
+    fill(owners.begin(), owners.end(), FREE_TILE);
     for (auto &tile : hexRing(CENTER, radius+1)) {
-        tiles.insert({tile, BORDER_TILE});
+        owners[index(tile)] = BORDER_TILE;
+    }
+
+    // the border is further away from the spawn centres than SPAWN_CLEARANCE
+    fill(numBlocking.begin(), numBlocking.end(), 0);
+    freeSpawnCenters = spawnCenters;
+    for (int i = 0; i < (int) freeSpawnCenters.size(); i++) {
+        freeSpawnIndex[freeSpawnCenters[i]] = i;
+    }
+}
+
+/**
+ * a tile became owned (change = 1) or free (change = -1),
+ * the spawn centres around it are updated
+ */
+void Board::updateSpawnCenters(Tile t, int change)
+{
+    for (auto &offset : clearanceArea) {
+        Tile center = subtract(t, offset);
+        if (!contains(center)) continue;
+
+        int i = index(center);
+        numBlocking[i] += change;
+
+        if (change > 0 && numBlocking[i] == 1 && freeSpawnIndex[i] >= 0) {
+            // swap the centre with the last free one and remove it
+            int last = freeSpawnCenters.back();
+            freeSpawnCenters[freeSpawnIndex[i]] = last;
+            freeSpawnIndex[last] = freeSpawnIndex[i];
+            freeSpawnCenters.pop_back();
+            freeSpawnIndex[i] = -1;
+        } else if (change < 0 && numBlocking[i] == 0 && hexDistance(CENTER, center) <= radius - 3) {
+            freeSpawnIndex[i] = freeSpawnCenters.size();
+            freeSpawnCenters.push_back(i);
+        }
     }
 }
 
@@ -58,18 +119,30 @@ int Board::getNumTiles()
 
 void Board::setFree(Tile tile)
 {
-    if (tiles.count(tile) > 0) {
-       tiles.erase(tile);
+    if (!contains(tile)) return;
+
+    int &owner = owners[index(tile)];
+
+    if (owner != FREE_TILE) {
+        owner = FREE_TILE;
+        updateSpawnCenters(tile, -1);
     }
 }
 
 void Board::setOwner(Tile tile, Player &player)
 {
-    if (tiles.count(tile) == 0) {
-        tiles.insert({tile, player.getId()});
-    } else {
-        tiles.at(tile) = player.getId();
+    if (!contains(tile)) {
+        cerr << "error: trying to own a tile outside of the board" << endl;
+        return;
     }
+
+    int &owner = owners[index(tile)];
+
+    if (owner == FREE_TILE) {
+        updateSpawnCenters(tile, 1);
+    }
+
+    owner = player.getId();
 }
 
 void Board::setOwner(const vector<Tile> &ts, Player &player)
@@ -88,11 +161,11 @@ void Board::setOwner(const unordered_set<Tile> &ts, Player &player)
 
 int Board::getOwner(Tile tile)
 {
-    if (tiles.count(tile) == 0) {
+    if (!contains(tile)) {
         return FREE_TILE;
     }
 
-    return tiles.at(tile);
+    return owners[index(tile)];
 }
 
 bool Board::isOwner(Tile tile, Player &player)
@@ -104,8 +177,10 @@ unordered_set<Tile> Board::getAll()
 {
     unordered_set<Tile> result;
 
-    for (auto &tile : tiles) {
-        result.insert(tile.first);
+    for (int i = 0; i < width * width; i++) {
+        if (owners[i] != FREE_TILE) {
+            result.insert(tileAt(i));
+        }
     }
 
     return result;
@@ -115,9 +190,9 @@ unordered_set<Tile> Board::getAllByOwner(Player &player)
 {
     unordered_set<Tile> result;
 
-    for (auto &tile : tiles) {
-        if (tile.second == (int) player.getId()) {
-            result.insert(tile.first);
+    for (int i = 0; i < width * width; i++) {
+        if (owners[i] == player.getId()) {
+            result.insert(tileAt(i));
         }
     }
 
@@ -127,14 +202,22 @@ unordered_set<Tile> Board::getAllByOwner(Player &player)
 int Board::freeAllByOwner(Player &player)
 {
     int num = 0;
-    auto it = tiles.cbegin();
-    
-    while (it != tiles.cend()) {
-        auto curr = it++;
-        
-        if (curr->second == (int) player.getId()) {
-            tiles.erase(curr);
-            num++;
+    TileBoundingBox bounds = player.getBoundingBox();
+
+    // inclusions may lie on the edge of the bounding box, see getInclusions
+    int minQ = max(bounds.min.q - 1, -radius);
+    int maxQ = min(bounds.max.q + 1, radius);
+    int minR = max(bounds.min.r - 1, -radius);
+    int maxR = min(bounds.max.r + 1, radius);
+
+    for (int q = minQ; q <= maxQ; q++) {
+        for (int r = minR; r <= maxR; r++) {
+            Tile tile = Tile{q, r};
+
+            if (owners[index(tile)] == player.getId()) {
+                setFree(tile);
+                num++;
+            }
         }
     }
     
@@ -202,17 +285,95 @@ unordered_set<Tile> Board::getInclusions(Player &player)
     return candidates;
 }
 
-Tile Board::getRandomTile()
+int Board::getNumSpawnTiles()
+{
+    return spawnCenters.size();
+}
+
+Tile Board::getSpawnTile(int i)
+{
+    return tileAt(spawnCenters[i]);
+}
+
+bool Board::getFreeSpawnTile(Rng &rng, Tile &tile)
+{
+    if (freeSpawnCenters.empty()) {
+        return false;
+    }
+
+    tile = tileAt(freeSpawnCenters[rng.nextInt(freeSpawnCenters.size())]);
+    return true;
+}
+
+int Board::getNumFreeSpawnTiles()
 {
-    Tile tile;
+    return freeSpawnCenters.size();
+}
+
+void Board::snapshot(SnapshotWriter &writer)
+{
+    writer.writeArray(owners.data(), owners.size());
+    writer.writeArray(numBlocking.data(), numBlocking.size());
+    writer.writeVector(freeSpawnCenters);
+    writer.writeArray(freeSpawnIndex.data(), freeSpawnIndex.size());
+}
 
-    do {
-        int randomQ = rand() % (radius * 2) - radius;
-        int randomR = rand() % (radius * 2) - radius;
-        
-        tile = Tile{randomQ, randomR};
-    } while (hexDistance(CENTER, tile) > radius-3);
+void Board::restore(SnapshotReader &reader, int numPlayers)
+{
+    // a dry run collects what it read, so the spawn centres can be checked
+    // against the owners: the following updates index with them
+    bool dryRun = reader.isDryRun();
+    vector<int> readOwners(dryRun ? owners.size() : 0);
+    vector<int> readBlocking(dryRun ? numBlocking.size() : 0);
+    vector<int> readCenters;
+    unsigned long numIndexed = 0;
+
+    auto isSpawnCenter = [&](int i) {
+        return hexDistance(CENTER, tileAt(i)) <= radius - 3;
+    };
+
+    reader.readArray(owners.data(), owners.size(), [&](int owner, size_t i) {
+        int distance = hexDistance(CENTER, tileAt(i));
+        readOwners[i] = owner;
+
+        if (distance == radius) return owner == BORDER_TILE;
+        if (distance > radius) return owner == FREE_TILE;
+        return owner == FREE_TILE || (owner >= 0 && owner < numPlayers);
+    });
+
+    reader.readArray(numBlocking.data(), numBlocking.size(), [&](int blocking, size_t i) {
+        int expected = 0;
+
+        for (auto &offset : clearanceArea) {
+            Tile t = add(tileAt(i), offset);
+            if (contains(t) && readOwners[index(t)] >= 0) expected++;
+        }
 
-    return tile;
-    //return Tile{3, 3};
-}
\ No newline at end of file
+        readBlocking[i] = blocking;
+        return blocking == expected;
+    });
+
+    // the free centres are restored in their order, so the following spawns are the same
+    reader.readVector(freeSpawnCenters, -1, [&](int center, size_t) {
+        if (center < 0 || center >= width * width || !isSpawnCenter(center) || readBlocking[center] != 0) {
+            return false;
+        }
+
+        readCenters.push_back(center);
+        return true;
+    });
+
+    reader.readArray(freeSpawnIndex.data(), freeSpawnIndex.size(), [&](int position, size_t i) {
+        if (position < 0) {
+            return position == -1 && !(isSpawnCenter(i) && readBlocking[i] == 0);
+        }
+
+        numIndexed++;
+        return position < (int) readCenters.size() && readCenters[position] == (int) i;
+    });
+
+    // every free centre is listed exactly once
+    if (dryRun && numIndexed != readCenters.size()) {
+        reader.fail();
+    }
+}
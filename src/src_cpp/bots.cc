@@ -0,0 +1,266 @@
+#include <cmath>
+#include <climits>
+#include "include/bots.h"
+#include "include/utils.h"
+
+using namespace std;
+
+
+Bot::Bot() : lastHead(CENTER), lastDirection(-1)
+{
+}
+
+Bot::~Bot() = default;
+
+Bot *Bot::create(int type)
+{
+    switch (type) {
+        case BOT_RANDOM: return new RandomBot();
+        case BOT_GRABBER: return new GrabberBot();
+        case BOT_HUNTER: return new HunterBot();
+        case BOT_DEFENSIVE: return new DefensiveBot();
+        default: return nullptr;
+    }
+}
+
+float Bot::toAngle(int direction)
+{
+    // inverse of Game::calcContinuousStep, which moves along (-sin(a), cos(a))
+    CartCoord c = hexToCart(tileToHex(DIRECTIONS[direction]));
+    return atan2(-c.x, c.y);
+}
+
+int Bot::act(Game &game, Player &player)
+{
+    Tile head = player.getHead();
+
+    if (lastDirection < 0 || head != lastHead || !isSafe(game, head, lastDirection)) {
+        lastDirection = chooseDirection(game, player);
+        lastHead = head;
+    }
+
+    return lastDirection;
+}
+
+void Bot::reset()
+{
+    lastDirection = -1;
+}
+
+void Bot::snapshot(SnapshotWriter &writer)
+{
+    writer.write(lastHead);
+    writer.write(lastDirection);
+}
+
+void Bot::restore(SnapshotReader &reader)
+{
+    reader.read(lastHead);
+    reader.read(lastDirection, [](int d) { return d >= -1 && d < 6; });
+}
+
+bool Bot::isSafe(Game &game, Tile head, int direction)
+{
+    return game.getBoard().getOwner(getNeighbor(head, direction)) != BORDER_TILE;
+}
+
+int Bot::randomSafeDirection(Game &game, Tile head)
+{
+    int safe[6];
+    int numSafe = 0;
+
+    for (int i = 0; i < 6; i++) {
+        if (isSafe(game, head, i)) {
+            safe[numSafe++] = i;
+        }
+    }
+
+    return numSafe > 0 ? safe[game.getRng().nextInt(numSafe)] : game.getRng().nextInt(6);
+}
+
+int Bot::directionTowards(Game &game, Tile head, Tile target)
+{
+    int best = -1;
+    int bestDistance = INT_MAX;
+
+    for (int i = 0; i < 6; i++) {
+        if (!isSafe(game, head, i)) continue;
+
+        int d = hexDistance(getNeighbor(head, i), target);
+
+        if (d < bestDistance) {
+            best = i;
+            bestDistance = d;
+        }
+    }
+
+    return best >= 0 ? best : randomSafeDirection(game, head);
+}
+
+int RandomBot::act(Game &game, Player &player)
+{
+    // decides in every step, like the random agents of HexarioEnv did
+    return chooseDirection(game, player);
+}
+
+int RandomBot::chooseDirection(Game &game, Player &player)
+{
+    return randomSafeDirection(game, player.getHead());
+}
+
+GrabberBot::GrabberBot(int minLegLength, int maxLegLength) :
+    minLegLength(minLegLength),
+    maxLegLength(maxLegLength),
+    leg(-1),
+    tilesInLeg(0),
+    legLength(minLegLength),
+    outDirection(0),
+    turn(1),
+    home(CENTER)
+{
+}
+
+void GrabberBot::reset()
+{
+    Bot::reset();
+    leg = -1;
+}
+
+void GrabberBot::snapshot(SnapshotWriter &writer)
+{
+    Bot::snapshot(writer);
+    writer.write(leg);
+    writer.write(tilesInLeg);
+    writer.write(legLength);
+    writer.write(outDirection);
+    writer.write(turn);
+    writer.write(home);
+}
+
+void GrabberBot::restore(SnapshotReader &reader)
+{
+    Bot::restore(reader);
+    reader.read(leg);
+    reader.read(tilesInLeg);
+    reader.read(legLength);
+    reader.read(outDirection, [](int d) { return d >= 0 && d < 6; });
+    reader.read(turn, [](int t) { return t >= 0 && t <= 10; });
+    reader.read(home);
+}
+
+void GrabberBot::returnHome()
+{
+    leg = 2;
+}
+
+int GrabberBot::chooseDirection(Game &game, Player &player)
+{
+    Tile head = player.getHead();
+
+    if (game.getBoard().isOwner(head, player)) {
+        // back home (or just spawned): plan the next loop
+        if (leg != 0) {
+            leg = 0;
+            tilesInLeg = 0;
+            Rng &rng = game.getRng();
+            legLength = minLegLength + rng.nextInt(maxLegLength - minLegLength + 1);
+            outDirection = randomSafeDirection(game, head);
+            turn = (rng.nextInt(2) ? 1 : 5) * (1 + rng.nextInt(2));
+        }
+
+        home = head;
+
+        if (!isSafe(game, head, outDirection)) {
+            outDirection = randomSafeDirection(game, head);
+        }
+
+        return outDirection;
+    }
+
+    tilesInLeg++;
+
+    if (leg < 2 && tilesInLeg >= legLength) {
+        leg++;
+        tilesInLeg = 0;
+    }
+
+    int direction;
+
+    switch (leg) {
+        case 0: direction = outDirection; break;
+        case 1: direction = (outDirection + turn) % 6; break;
+        default: direction = directionTowards(game, head, home);
+    }
+
+    if (!isSafe(game, head, direction)) {
+        returnHome();
+        direction = directionTowards(game, head, home);
+    }
+
+    return direction;
+}
+
+HunterBot::HunterBot(int huntRadius) : GrabberBot(), huntRadius(huntRadius)
+{
+}
+
+int HunterBot::chooseDirection(Game &game, Player &player)
+{
+    Tile head = player.getHead();
+    Tile target = head;
+    int targetDistance = huntRadius + 1;
+
+    for (auto &other : game.getPlayers()) {
+        if (other == player || other.isDead()) continue;
+
+        for (auto &tile : other.getClaim()) {
+            int d = hexDistance(head, tile);
+
+            if (d < targetDistance) {
+                target = tile;
+                targetDistance = d;
+            }
+        }
+    }
+
+    if (targetDistance > huntRadius) {
+        return GrabberBot::chooseDirection(game, player);
+    }
+
+    // go home after the hunt
+    returnHome();
+    return directionTowards(game, head, target);
+}
+
+DefensiveBot::DefensiveBot(int dangerRadius) : GrabberBot(1, 3), dangerRadius(dangerRadius)
+{
+}
+
+int DefensiveBot::chooseDirection(Game &game, Player &player)
+{
+    Tile head = player.getHead();
+
+    for (auto &other : game.getPlayers()) {
+        if (other == player || other.isDead()) continue;
+
+        if (hexDistance(head, other.getHead()) > dangerRadius) continue;
+
+        // stay within the territory while the other one is close
+        if (game.getBoard().isOwner(head, player)) {
+            int offset = game.getRng().nextInt(6);
+
+            for (int i = 0; i < 6; i++) {
+                int direction = (offset + i) % 6;
+
+                if (game.getBoard().isOwner(getNeighbor(head, direction), player)) {
+                    return direction;
+                }
+            }
+        }
+
+        returnHome();
+        break;
+    }
+
+    return GrabberBot::chooseDirection(game, player);
+}
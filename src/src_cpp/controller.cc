@@ -3,9 +3,16 @@
 #include <cstdlib>
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <cstdint>
 #include "include/controller.h"
 #include "include/utils.h"
 
+#ifndef HEXARIO_HEADLESS
+#include "include/renderer.h"
+#include "include/recorder.h"
+#endif
+
 using namespace std;
 
 // INVALID is used for tiles outside the arena and 
@@ -41,7 +48,16 @@ Controller::Controller(
         int observationRadius,
         int pxObservationWidth,
         int pxObservationHeight,
-        float defaultVelocity
+        float defaultVelocity,
+        int pxSupersampling,
+        int numRenderThreads,
+        bool sharedGlobalRender,
+        RewardWeights rewardWeights,
+        int maxSteps,
+        bool autoReset,
+        const vector<int> &botTypes,
+        uint64_t seed,
+        int numHeadings
         ) : 
     mapRadius(mapRadius), 
     numPlayers(numPlayers),
@@ -51,18 +67,101 @@ Controller::Controller(
     observationRadius(observationRadius),
     pxObservationWidth(pxObservationWidth),
     pxObservationHeight(pxObservationHeight),
-    game(numPlayers, mapRadius, discreteActionSpace, defaultVelocity)
+    pxSupersampling(pxSupersampling),
+    numRenderThreads(max(numRenderThreads, 1)),
+    sharedGlobalRender(sharedGlobalRender && !featureObservations && !localPerspective),
+    rewardWeights(rewardWeights),
+    maxSteps(maxSteps),
+    autoReset(autoReset),
+    botTypes(botTypes),
+    game(numPlayers, mapRadius, discreteActionSpace, defaultVelocity, seed, numHeadings),
+    takenSteps(numPlayers, 0),
+    respawned(numPlayers, false),
+    bots(numPlayers, nullptr),
+    actionBuffer(numPlayers),
+    hasBots(false),
+    prevCaptures(numPlayers, 0),
+    prevClaims(numPlayers, 0),
+    prevKills(numPlayers, 0)
 {
-    observationRenderer = new ObservationRenderer(game, pxObservationWidth, pxObservationHeight);
-    observationRenderer->setScale(OBS_SCALE);
+    renderPool = nullptr;
+    semanticRenderer = nullptr;
+    semanticFrameValid = false;
+    recorder = nullptr;
+
+    if (this->numRenderThreads > 1) {
+        renderPool = new ThreadPool(this->numRenderThreads);
+    }
+
+    for (int i = 0; i < numPlayers && i < (int) botTypes.size(); i++) {
+        bots[i] = Bot::create(botTypes[i]);
+        hasBots = hasBots || bots[i] != nullptr;
+    }
+
     windowRenderer = nullptr;
 }
 
 Controller::~Controller()
 {
-    delete observationRenderer;
+    delete renderPool;
+    for (auto *bot : bots) {
+        delete bot;
+    }
+#ifndef HEXARIO_HEADLESS
+    for (auto *renderer : observationRenderers) {
+        delete renderer;
+    }
+    delete semanticRenderer;
     delete windowRenderer;
-    SDL_Quit();
+    delete recorder;
+#endif
+}
+
+/**
+ * creates one observation renderer per render thread. This has to happen
+ * on the calling thread before any observation is rendered in parallel.
+ */
+void Controller::createObservationRenderers()
+{
+#ifndef HEXARIO_HEADLESS
+    if (featureObservations || !observationRenderers.empty()) {
+        return;
+    }
+
+    for (int i = 0; i < numRenderThreads; i++) {
+        auto *renderer = new ObservationRenderer(game, pxObservationWidth, pxObservationHeight, pxSupersampling);
+        renderer->setScale(OBS_SCALE);
+        observationRenderers.push_back(renderer);
+    }
+
+    if (sharedGlobalRender) {
+        semanticRenderer = new ObservationRenderer(game, pxObservationWidth, pxObservationHeight, pxSupersampling);
+        semanticRenderer->setScale(getGlobalPixelScale());
+        semanticRenderer->setFocus(CartCoord{0, 0});
+    }
+#endif
+}
+
+float Controller::getGlobalPixelScale()
+{
+    float numUnits = (1 + mapRadius * 2) * 1.5;
+    return (float) pxObservationHeight / numUnits;
+}
+
+/**
+ * renders the semantic frame if the game has changed since the last one.
+ * Has to be called on the calling thread before observations are generated.
+ */
+void Controller::prepareSemanticFrame()
+{
+#ifndef HEXARIO_HEADLESS
+    if (!sharedGlobalRender || semanticFrameValid) {
+        return;
+    }
+
+    semanticRenderer->renderSemantic();
+    semanticFrameValid = true;
+#endif
 }
 
 bool Controller::isPerspectiveLocal()
@@ -70,6 +169,26 @@ bool Controller::isPerspectiveLocal()
     return localPerspective;
 }
 
+bool Controller::isActionSpaceDiscrete()
+{
+    return discreteActionSpace;
+}
+
+Game &Controller::getGame()
+{
+    return game;
+}
+
+bool Controller::isBot(int playerId)
+{
+    return playerId >= 0 && playerId < numPlayers && bots[playerId] != nullptr;
+}
+
+std::mutex &Controller::getMutex()
+{
+    return callMutex;
+}
+
 void Controller::printInfo()
 {
     cout << "Game info" << endl;
@@ -79,19 +198,290 @@ void Controller::printInfo()
     cout << "perspective: " << (localPerspective ? "local" : "global") << endl;
     cout << "observation type: " << (featureObservations ? "features" : "pixel") << endl;
     cout << "action space: " << (discreteActionSpace ? "discrete" : "continuous") << endl;
+    if (!discreteActionSpace) {
+        cout << "headings: " << (game.getNumHeadings() > 0 ? to_string(game.getNumHeadings()) : "any") << endl;
+    }
     cout << "observation radius: " << observationRadius << endl;
     cout << "pixel observation size: " << pxObservationWidth << " x " << pxObservationHeight << " x 3" << endl; 
+    cout << "pixel supersampling: " << pxSupersampling << endl;
+    cout << "render threads: " << numRenderThreads << endl;
+    cout << "shared global rendering: " << (sharedGlobalRender ? "yes" : "no") << endl;
+    cout << "max steps: " << maxSteps << endl;
+    cout << "auto reset: " << (autoReset ? "yes" : "no") << endl;
+    cout << "bots: " << count_if(bots.begin(), bots.end(), [](Bot *bot) { return bot != nullptr; }) << endl;
     cout << "-----------------------" << endl;
 }
 
 void Controller::resetPlayer(int playerId)
 {
+    if (playerId < 0 || playerId >= numPlayers) {
+        cerr << "error: trying to reset a player that does not exist" << endl;
+        return;
+    }
+
     game.resetPlayer(playerId);
+    takenSteps[playerId] = 0;
+
+    if (bots[playerId] != nullptr) {
+        bots[playerId]->reset();
+    }
+    semanticFrameValid = false;
+}
+
+void Controller::resetAll()
+{
+    game.resetAll();
+    semanticFrameValid = false;
+
+    for (int i = 0; i < numPlayers; i++) {
+        takenSteps[i] = 0;
+
+        if (bots[i] != nullptr) {
+            bots[i]->reset();
+        }
+    }
+}
+
+void Controller::seed(uint64_t seed)
+{
+    game.seed(seed);
+}
+
+const vector<char> &Controller::snapshot()
+{
+    snapshotBuffer.clear();
+    SnapshotWriter writer(snapshotBuffer);
+
+    // the bots are part of the configuration, their plans follow at the end
+    for (int i = 0; i < numPlayers; i++) {
+        writer.write(bots[i] != nullptr ? botTypes[i] : BOT_NONE);
+    }
+
+    game.snapshot(writer);
+    writer.writeVector(takenSteps);
+    writer.writeVector(respawned);
+
+    for (auto *bot : bots) {
+        if (bot != nullptr) {
+            bot->snapshot(writer);
+        }
+    }
+
+    return snapshotBuffer;
+}
+
+bool Controller::restore(const char *data, size_t size)
+{
+    // the whole snapshot is checked before anything is changed
+    SnapshotReader check(data, size, true);
+
+    if (!restore(check)) {
+        cerr << "error: the snapshot is corrupted or does not belong to a game of this configuration" << endl;
+        return false;
+    }
+
+    restoreTrusted(data, size);
+
+    return true;
+}
+
+void Controller::restoreTrusted(const char *data, size_t size)
+{
+    SnapshotReader reader(data, size);
+    restore(reader);
+    semanticFrameValid = false;
+}
+
+bool Controller::restore(SnapshotReader &reader)
+{
+    for (int i = 0; i < numPlayers; i++) {
+        if (!reader.expect(bots[i] != nullptr ? botTypes[i] : BOT_NONE)) {
+            return false;
+        }
+    }
+
+    if (!game.restore(reader)) {
+        return false;
+    }
+
+    reader.readVector(takenSteps, numPlayers, [](int steps, size_t) { return steps >= 0; });
+    reader.readVector(respawned, numPlayers, [](char r, size_t) { return r == 0 || r == 1; });
+
+    for (auto *bot : bots) {
+        if (bot != nullptr) {
+            bot->restore(reader);
+        }
+    }
+
+    return reader.isComplete();
+}
+
+Controller *Controller::clone()
+{
+    // the velocity of the players is part of the snapshot
+    auto *copy = new Controller(mapRadius, numPlayers, localPerspective, featureObservations, discreteActionSpace,
+                                observationRadius, pxObservationWidth, pxObservationHeight,
+                                game.getPlayer(0).getVelocity(), pxSupersampling, 1, sharedGlobalRender,
+                                rewardWeights, maxSteps, autoReset, botTypes, 0, game.getNumHeadings());
+
+    const vector<char> &state = snapshot();
+    copy->restoreTrusted(state.data(), state.size());
+
+    return copy;
 }
 
-void Controller::takeActions(vector<float> actions)
+template<typename T>
+void Controller::takeActions(const T *actions)
 {
+    if (hasBots) {
+        // the buffer is large enough for every action type
+        T *merged = (T *) actionBuffer.data();
+
+        for (int i = 0; i < numPlayers; i++) {
+            Player &player = game.getPlayer(i);
+
+            if (bots[i] == nullptr || player.isDead()) {
+                merged[i] = actions[i];
+                continue;
+            }
+
+            int direction = bots[i]->act(game, player);
+            merged[i] = discreteActionSpace ? (T) direction : (T) Bot::toAngle(direction);
+        }
+
+        actions = merged;
+    }
+
     game.takeActions(actions);
+    semanticFrameValid = false;
+
+    for (int i = 0; i < numPlayers; i++) {
+        takenSteps[i]++;
+        respawned[i] = false;
+    }
+
+#ifndef HEXARIO_HEADLESS
+    if (recorder != nullptr) {
+        recorder->capture();
+    }
+#endif
+}
+
+template<typename T>
+void Controller::takeActions(const T *actions, float *rewards, bool *dones)
+{
+    // remember the counters from before the step
+    for (int i = 0; i < numPlayers; i++) {
+        Player &player = game.getPlayer(i);
+        prevCaptures[i] = player.getNumCaptures();
+        prevClaims[i] = player.getNumClaims();
+        prevKills[i] = player.getNumKills();
+    }
+
+    takeActions(actions);
+
+    for (int i = 0; i < numPlayers; i++) {
+        Player &player = game.getPlayer(i);
+        float reward = rewardWeights.timestep;
+
+        if (!player.isDead()) {
+            reward += rewardWeights.capture * (player.getNumCaptures() - prevCaptures[i]);
+            reward += rewardWeights.claim * max(player.getNumClaims() - prevClaims[i], 0);
+            reward += rewardWeights.kill * max(player.getNumKills() - prevKills[i], 0);
+        }
+
+        rewards[i] = reward;
+        dones[i] = player.isDead() || player.isWinner() || takenSteps[i] >= maxSteps;
+    }
+}
+
+template<typename T>
+void Controller::step(const T *actions, float *rewards, bool *dones, int infoFields, char *info)
+{
+    takeActions(actions, rewards, dones);
+
+    for (int i = 0; i < numPlayers; i++) {
+        respawned[i] = autoReset && dones[i];
+    }
+
+    getInfo(infoFields, info);
+
+    for (int i = 0; i < numPlayers; i++) {
+        if (respawned[i]) {
+            resetPlayer(i);
+        }
+    }
+}
+
+#define INSTANTIATE_TAKE_ACTIONS(T) \
+    template void Controller::takeActions<T>(const T *actions); \
+    template void Controller::takeActions<T>(const T *actions, float *rewards, bool *dones); \
+    template void Controller::step<T>(const T *actions, float *rewards, bool *dones, int infoFields, char *info);
+FOR_EACH_ACTION_TYPE(INSTANTIATE_TAKE_ACTIONS)
+
+int Controller::getNumPlayers()
+{
+    return numPlayers;
+}
+
+int Controller::getTakenSteps(int playerId)
+{
+    if (playerId < 0 || playerId >= numPlayers) {
+        cerr << "error: trying to get the steps of a player that does not exist" << endl;
+        return 0;
+    }
+
+    return takenSteps[playerId];
+}
+
+long int Controller::getInfoRecordSize(int infoFields)
+{
+    long int size = 0;
+    if (infoFields & INFO_KILLS) size += sizeof(int32_t);
+    if (infoFields & INFO_CAPTURES) size += sizeof(int32_t);
+    if (infoFields & INFO_CLAIMS) size += sizeof(int32_t);
+    if (infoFields & INFO_COVERAGE) size += sizeof(float);
+    if (infoFields & INFO_WINNER) size += sizeof(bool);
+    if (infoFields & INFO_DEAD) size += sizeof(bool);
+    if (infoFields & INFO_DISTANCES) size += 6 * sizeof(float);
+    if (infoFields & INFO_STEPS) size += sizeof(int32_t);
+    if (infoFields & INFO_RESET) size += sizeof(bool);
+    return size;
+}
+
+/**
+ * appends one field to a packed record, the fields are not aligned
+ */
+template<typename T>
+static inline void writeInfoField(char *&out, T value)
+{
+    memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+}
+
+void Controller::getInfo(int infoFields, char *out)
+{
+    float numTiles = 1 + 3 * mapRadius * (mapRadius - 1);
+
+    for (int i = 0; i < numPlayers; i++) {
+        Player &player = game.getPlayer(i);
+
+        if (infoFields & INFO_KILLS) writeInfoField<int32_t>(out, player.getNumKills());
+        if (infoFields & INFO_CAPTURES) writeInfoField<int32_t>(out, player.getNumCaptures());
+        if (infoFields & INFO_CLAIMS) writeInfoField<int32_t>(out, player.getNumClaims());
+        if (infoFields & INFO_COVERAGE) writeInfoField<float>(out, player.getNumCaptures() / numTiles);
+        if (infoFields & INFO_WINNER) writeInfoField<bool>(out, player.isWinner());
+        if (infoFields & INFO_DEAD) writeInfoField<bool>(out, player.isDead());
+
+        if (infoFields & INFO_DISTANCES) {
+            for (float distance : getDistancesToBorder(i)) {
+                writeInfoField<float>(out, distance);
+            }
+        }
+
+        if (infoFields & INFO_STEPS) writeInfoField<int32_t>(out, takenSteps[i]);
+        if (infoFields & INFO_RESET) writeInfoField<bool>(out, respawned[i]);
+    }
 }
 
 bool Controller::isDead(int playerId)
@@ -119,6 +509,22 @@ int Controller::getNumClaims(int playerId)
     return game.getPlayer(playerId).getNumClaims();
 }
 
+void Controller::getActionMasks(int numAgents, unsigned char *safe, unsigned char *danger)
+{
+    for (int i = 0; i < numAgents && i < numPlayers; i++) {
+        Player &player = game.getPlayer(i);
+        int safeMask = 0x3f;
+        int dangerMask = 0;
+
+        if (!player.isDead()) {
+            game.getActionMasks(player, safeMask, dangerMask);
+        }
+
+        safe[i] = (unsigned char) safeMask;
+        danger[i] = (unsigned char) dangerMask;
+    }
+}
+
 vector<float> Controller::getDistancesToBorder(int playerId)
 {
     // for each direction, return the distance in tile coodinates to the next border
@@ -126,8 +532,7 @@ vector<float> Controller::getDistancesToBorder(int playerId)
     vector<float> result{maxDist, maxDist, maxDist, maxDist, maxDist, maxDist};
 
     // get the current tile position of the player
-    CartCoord pos = game.getPlayer(playerId).getPosition();
-    Tile tilePos = cartToTile(pos);
+    Tile tilePos = game.getPlayer(playerId).getHead();
 
     for (int i = 0; i < 6; i++) {
         Tile t = tilePos;
@@ -149,12 +554,54 @@ vector<float> Controller::getDistancesToBorder(int playerId)
 
 bool Controller::show()
 {
+#ifdef HEXARIO_HEADLESS
+    cerr << "error: hexario was built without SDL, the game cannot be shown" << endl;
+    return false;
+#else
     if (windowRenderer == nullptr) {
         windowRenderer = new DemoRenderer(game, WIN_WIDTH, WIN_HEIGHT);
         windowRenderer->setScale(WIN_SCALE);
     }
 
     return windowRenderer->render();
+#endif
+}
+
+bool Controller::startRecording(const string &path, int format, int width, int height, int queueSize)
+{
+#ifdef HEXARIO_HEADLESS
+    cerr << "error: hexario was built without SDL, the game cannot be recorded" << endl;
+    return false;
+#else
+    delete recorder;
+    recorder = new Recorder(game, path, format, width, height, queueSize);
+
+    if (!recorder->isOpen()) {
+        delete recorder;
+        recorder = nullptr;
+        return false;
+    }
+
+    // the first frame shows the state the recording started from
+    recorder->capture();
+    return true;
+#endif
+}
+
+bool Controller::stopRecording(long &numWritten, long &numDropped)
+{
+#ifndef HEXARIO_HEADLESS
+    if (recorder != nullptr) {
+        recorder->close();
+        numWritten = recorder->getNumWritten();
+        numDropped = recorder->getNumDropped();
+
+        delete recorder;
+        recorder = nullptr;
+        return true;
+    }
+#endif
+    return false;
 }
 
 long int Controller::getObservationSize()
@@ -169,6 +616,39 @@ long int Controller::getObservationSize()
 }
 
 void Controller::getObservation(int playerId, float *obsMemAddr, long int size)
+{
+    createObservationRenderers();
+    prepareSemanticFrame();
+    getObservation(playerId, observationRenderers.empty() ? nullptr : observationRenderers[0], obsMemAddr, size);
+}
+
+void Controller::getObservations(int numAgents, float *obsMemAddr, long int size)
+{
+    long int observationSize = getObservationSize();
+
+    if (numAgents < 0 || numAgents > numPlayers || size != numAgents * observationSize) {
+        cerr << "error: cannot write observations of " << numAgents << " agents to memory of size " << size << endl;
+        return;
+    }
+
+    createObservationRenderers();
+    prepareSemanticFrame();
+
+    auto work = [&](int playerId, int workerId) {
+        getObservation(playerId, observationRenderers.empty() ? nullptr : observationRenderers[workerId],
+                       obsMemAddr + playerId * observationSize, observationSize);
+    };
+
+    if (renderPool != nullptr) {
+        renderPool->parallelFor(numAgents, work);
+    } else {
+        for (int i = 0; i < numAgents; i++) {
+            work(i, 0);
+        }
+    }
+}
+
+void Controller::getObservation(int playerId, ObservationRenderer *renderer, float *obsMemAddr, long int size)
 {
     if (playerId < 0 || playerId >= numPlayers) {
         cerr << "error: player with id " << playerId << " does not exist" << endl;
@@ -191,9 +671,9 @@ void Controller::getObservation(int playerId, float *obsMemAddr, long int size)
     } else if (featureObservations && !localPerspective) {
         getGlobalFeatureObservation(player, obsMemAddr, size);
     } else if (!featureObservations && localPerspective) {
-        getLocalPixelObservation(player, obsMemAddr, size);
+        getLocalPixelObservation(player, renderer, obsMemAddr, size);
     } else {
-        getGlobalPixelObservation(player, obsMemAddr, size);
+        getGlobalPixelObservation(player, renderer, obsMemAddr, size);
     }
 }
 
@@ -222,7 +702,7 @@ float Controller::getFeatureObservationCode(Player &player, Tile tile)
 
     // check claims, these will override the captures in the observation
     for (auto &p : game.getPlayers()) {
-        if (hexToTile(cartToHex(p.getPosition())) == tile) {
+        if (p.getHead() == tile) {
             if (p == player) {
                 // claimed by player
                 result = FEATURE_OBSERVATION_OWN_POSITION;
@@ -244,32 +724,43 @@ float Controller::getFeatureObservationCode(Player &player, Tile tile)
     return result;
 }
 
-void Controller::getLocalPixelObservation(Player &player, float *obsMemAddr, long int size)
+void Controller::getLocalPixelObservation(Player &player, ObservationRenderer *renderer, float *obsMemAddr, long int size)
 {
+#ifdef HEXARIO_HEADLESS
+    cerr << "error: hexario was built without SDL, pixel observations are not available" << endl;
+#else
     float numUnits = (1 + observationRadius * 2) * 1.5;
     float scale = (float) pxObservationHeight / numUnits;
 
-    observationRenderer->setScale(scale);
-    observationRenderer->setFocus(player.getPosition());
-    observationRenderer->renderForPlayer(player);
-    observationRenderer->writeTo(obsMemAddr, size);
+    renderer->setScale(scale);
+    renderer->setFocus(player.getPosition());
+    renderer->renderForPlayer(player);
+    renderer->writeTo(obsMemAddr, size);
+#endif
 }
 
-void Controller::getGlobalPixelObservation(Player &player, float *obsMemAddr, long int size)
+void Controller::getGlobalPixelObservation(Player &player, ObservationRenderer *renderer, float *obsMemAddr, long int size)
 {
-    float numUnits = (1 + mapRadius * 2) * 1.5;
-    float scale = (float) pxObservationHeight / numUnits;
+#ifdef HEXARIO_HEADLESS
+    cerr << "error: hexario was built without SDL, pixel observations are not available" << endl;
+#else
+    if (sharedGlobalRender) {
+        renderer->writeFromSemantic(*semanticRenderer, player, player.getPosition(), observationRadius,
+                                    obsMemAddr, size);
+        return;
+    }
 
-    observationRenderer->setScale(scale);
-    observationRenderer->setFocus(CartCoord{0, 0});
-    observationRenderer->renderForPlayer(player);
-    observationRenderer->showOnly(player.getPosition(), observationRadius);
-    observationRenderer->writeTo(obsMemAddr, size);
+    renderer->setScale(getGlobalPixelScale());
+    renderer->setFocus(CartCoord{0, 0});
+    renderer->renderForPlayer(player);
+    renderer->showOnly(player.getPosition(), observationRadius);
+    renderer->writeTo(obsMemAddr, size);
+#endif
 }
 
 void Controller::getLocalFeatureObservation(Player &player, float *obsMemAddr, long int size)
 {
-    Tile pos = hexToTile(cartToHex(player.getPosition()));
+    Tile pos = player.getHead();
     vector<Tile> scope = hexArea(pos, observationRadius);
     
     if (scope.size() != (unsigned long int) size) {
@@ -285,7 +776,7 @@ void Controller::getLocalFeatureObservation(Player &player, float *obsMemAddr, l
 
 void Controller::getGlobalFeatureObservation(Player &player, float *obsMemAddr, long int size)
 {
-    Tile pos = hexToTile(cartToHex(player.getPosition()));
+    Tile pos = player.getHead();
     vector<Tile> mapScope = hexArea(CENTER, mapRadius);
     vector<Tile> visibleScope = hexArea(pos, observationRadius);
     
@@ -0,0 +1,228 @@
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "include/env_server.h"
+
+using namespace std;
+
+
+/**
+ * rounds size up to a multiple of SERVER_ALIGNMENT, so every array starts on its own cache line
+ */
+static int64_t align(int64_t size)
+{
+    return (size + SERVER_ALIGNMENT - 1) / SERVER_ALIGNMENT * SERVER_ALIGNMENT;
+}
+
+/**
+ * reads or writes exactly size bytes, returns false if the peer disconnected
+ */
+static bool readFully(int fd, char *buffer, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = read(fd, buffer, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool writeFully(int fd, const char *buffer, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = write(fd, buffer, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer += n;
+        size -= n;
+    }
+    return true;
+}
+
+
+EnvServer::EnvServer(VectorController &vc, const string &socketPath, const string &shmName,
+                     int numEnvs, int envOffset, int infoFields, int numSlots) :
+    vc(vc),
+    socketPath(socketPath),
+    shmName(shmName),
+    envOffset(envOffset),
+    layout(getLayout(numSlots, numEnvs, vc.getNumAgents(), vc.getObservationSize(), infoFields)),
+    memory(NULL),
+    memorySize(layout.slotsOffset + numSlots * layout.slotSize),
+    listenSocket(-1),
+    failed(false)
+{
+    if (envOffset < 0 || envOffset + vc.getNumEnvs() > numEnvs) {
+        cerr << "error: the environments of the server exceed the shared memory" << endl;
+        failed = true;
+        return;
+    }
+
+    // every server of the segment opens it, the client unlinks it
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0) {
+        cerr << "error: cannot open shared memory " << shmName << ": " << strerror(errno) << endl;
+        failed = true;
+        return;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) < 0 || (status.st_size < memorySize && ftruncate(fd, memorySize) < 0)) {
+        cerr << "error: cannot resize shared memory " << shmName << ": " << strerror(errno) << endl;
+        close(fd);
+        failed = true;
+        return;
+    }
+
+    void *address = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (address == MAP_FAILED) {
+        cerr << "error: cannot map shared memory " << shmName << ": " << strerror(errno) << endl;
+        failed = true;
+        return;
+    }
+
+    memory = (char *) address;
+
+    // all servers write the same layout
+    memcpy(memory, &layout, sizeof(ServerLayout));
+
+    struct sockaddr_un socketAddress;
+    memset(&socketAddress, 0, sizeof(socketAddress));
+    socketAddress.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(socketAddress.sun_path)) {
+        cerr << "error: socket path " << socketPath << " is too long" << endl;
+        failed = true;
+        return;
+    }
+
+    strcpy(socketAddress.sun_path, socketPath.c_str());
+    unlink(socketPath.c_str());
+
+    listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket < 0
+        || bind(listenSocket, (struct sockaddr *) &socketAddress, sizeof(socketAddress)) < 0
+        || listen(listenSocket, 1) < 0) {
+        cerr << "error: cannot listen on " << socketPath << ": " << strerror(errno) << endl;
+        failed = true;
+    }
+}
+
+EnvServer::~EnvServer()
+{
+    if (listenSocket >= 0) {
+        close(listenSocket);
+        unlink(socketPath.c_str());
+    }
+
+    if (memory != NULL) {
+        munmap(memory, memorySize);
+    }
+}
+
+ServerLayout EnvServer::getLayout(int numSlots, int numEnvs, int numAgents, long int observationSize, int infoFields)
+{
+    int64_t numEntries = (int64_t) numEnvs * numAgents;
+
+    ServerLayout layout;
+    layout.magic = SERVER_MAGIC;
+    layout.numSlots = numSlots;
+    layout.numEnvs = numEnvs;
+    layout.numAgents = numAgents;
+    layout.observationSize = observationSize;
+    layout.infoFields = infoFields;
+    layout.infoRecordSize = Controller::getInfoRecordSize(infoFields);
+    layout.slotsOffset = align(sizeof(ServerLayout));
+
+    layout.actionsOffset = 0;
+    layout.observationsOffset = align(layout.actionsOffset + numEntries * sizeof(float));
+    layout.rewardsOffset = align(layout.observationsOffset + numEntries * observationSize * sizeof(float));
+    layout.donesOffset = align(layout.rewardsOffset + numEntries * sizeof(float));
+    layout.infoOffset = align(layout.donesOffset + numEntries * sizeof(bool));
+    layout.slotSize = align(layout.infoOffset + numEntries * layout.infoRecordSize);
+
+    return layout;
+}
+
+bool EnvServer::hasFailed()
+{
+    return failed;
+}
+
+char *EnvServer::getSlot(int slot)
+{
+    return memory + layout.slotsOffset + slot * layout.slotSize;
+}
+
+bool EnvServer::handle(const ServerMessage &message)
+{
+    if (message.slot < 0 || message.slot >= layout.numSlots) {
+        cerr << "error: invalid slot " << message.slot << endl;
+        return false;
+    }
+
+    // the arrays of this server's environments within the slot
+    char *slot = getSlot(message.slot);
+    int64_t first = (int64_t) envOffset * layout.numAgents;
+
+    float *actions = (float *) (slot + layout.actionsOffset) + first;
+    float *observations = (float *) (slot + layout.observationsOffset) + first * layout.observationSize;
+    float *rewards = (float *) (slot + layout.rewardsOffset) + first;
+    bool *dones = (bool *) (slot + layout.donesOffset) + first;
+    char *info = slot + layout.infoOffset + first * layout.infoRecordSize;
+
+    lock_guard<mutex> lock(vc.getMutex());
+
+    switch (message.command) {
+        case SERVER_RESET:
+            vc.reset();
+            vc.getObservations(observations);
+            return true;
+        case SERVER_STEP:
+            for (int64_t i = 0; i < (int64_t) vc.getNumEnvs() * layout.numAgents; i++) {
+                if (!Game::isValidAction(actions[i], vc.isActionSpaceDiscrete())) {
+                    cerr << "error: invalid action " << actions[i] << " of entry " << i << endl;
+                    return false;
+                }
+            }
+
+            vc.step(actions, observations, rewards, dones, (int) layout.infoFields, info);
+            return true;
+        default:
+            cerr << "error: invalid command " << message.command << endl;
+            return false;
+    }
+}
+
+void EnvServer::serve()
+{
+    if (failed) return;
+
+    int client = accept(listenSocket, NULL, NULL);
+    if (client < 0) {
+        cerr << "error: cannot accept a client on " << socketPath << ": " << strerror(errno) << endl;
+        return;
+    }
+
+    ServerMessage message;
+
+    while (readFully(client, (char *) &message, sizeof(ServerMessage))) {
+        if (message.command == SERVER_CLOSE) break;
+
+        ServerMessage reply = {handle(message) ? SERVER_OK : SERVER_ERROR, message.slot};
+
+        if (!writeFully(client, (const char *) &reply, sizeof(ServerMessage))) break;
+    }
+
+    close(client);
+}
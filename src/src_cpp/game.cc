@@ -1,5 +1,8 @@
 #include <iostream>
+#include <cmath>
+#include <algorithm>
 #include <vector>
+#include <climits>
 #include <unordered_set>
 
 #include "include/game.h"
@@ -7,9 +10,22 @@
 using namespace std;
 
 
-Game::Game(int numPlayers, int mapRadius, bool discrete, float velocity) 
-: numPlayers(numPlayers), mapRadius(mapRadius), discrete(discrete), board(mapRadius)
+Game::Game(int numPlayers, int mapRadius, bool discrete, float velocity, uint64_t seed, int numHeadings) 
+: numPlayers(numPlayers), mapRadius(mapRadius), numHeadings(max(numHeadings, 0)),
+  movement(discrete ? MOVE_TILES : (numHeadings > 0 ? MOVE_HEADINGS : MOVE_FREE)),
+  rng(seed), board(mapRadius), moveStarts(numPlayers), moveEnds(numPlayers),
+  fixedMoveStarts(numPlayers), fixedMoveEnds(numPlayers), capturesFrom(numPlayers + 1, 0)
 {
+    // heading 0 points to DIRECTIONS[0], so a multiple of 6 headings holds all tile directions
+    CartCoord first = hexToCart(tileToHex(DIRECTIONS[0]));
+    firstHeading = atan2(-first.x, first.y);
+
+    // unit vectors along (-sin(a), cos(a)) like calcContinuousStep
+    for (int i = 0; i < this->numHeadings; i++) {
+        double angle = firstHeading + 2 * M_PI * i / this->numHeadings;
+        headings.push_back(cartToFixed(CartCoord{(float) -sin(angle), (float) cos(angle)}));
+    }
+
     for (int i = 0; i < numPlayers; i++) {
         players.push_back(Player(i, velocity));
         resetPlayer(i);
@@ -23,6 +39,21 @@ Board &Game::getBoard()
     return board;
 }
 
+int Game::getNumHeadings()
+{
+    return numHeadings;
+}
+
+const vector<GameEvent> &Game::getEvents()
+{
+    return events;
+}
+
+void Game::addEvent(int type, Player &player, int other, int value, Tile tile)
+{
+    events.push_back(GameEvent{type, player.getId(), other, value, tile.q, tile.r});
+}
+
 Player &Game::getPlayer(int playerId)
 {
     if (playerId >= 0 && playerId < numPlayers) {
@@ -38,6 +69,16 @@ vector<Player> &Game::getPlayers()
     return players;
 }
 
+Rng &Game::getRng()
+{
+    return rng;
+}
+
+void Game::seed(uint64_t seed)
+{
+    rng.seed(seed);
+}
+
 void Game::setDead(Player &player)
 {
     player.setDead(true);
@@ -48,12 +89,168 @@ void Game::resetPlayer(int playerId)
 {
     Player &player = getPlayer(playerId);
     board.freeAllByOwner(player);
-    Tile spawnPoint = board.getRandomTile();
+    Tile spawnPoint = findSpawnPoint(player);
     player.spawn(spawnPoint);
-    board.setOwner(hexArea(spawnPoint, 2), player);
+
+    // only if the board is too crowded for a free spawn area, other
+    // territory is taken over. Its owners lose the tiles like on a capture.
+    for (auto &tile : hexArea(spawnPoint, SPAWN_AREA_RADIUS)) {
+        int prevOwnerId = board.getOwner(tile);
+
+        if (prevOwnerId >= 0 && prevOwnerId != playerId) {
+            Player &prevOwner = getPlayer(prevOwnerId);
+            prevOwner.addCaptures(-1);
+
+            if (prevOwner.getNumCaptures() <= 0) {
+                setDead(prevOwner);
+                addEvent(EVENT_DIED, prevOwner, playerId, CAUSE_SPAWN);
+            }
+        }
+
+        board.setOwner(tile, player);
+    }
+}
+
+void Game::resetAll()
+{
+    events.clear();
+
+    for (auto &player : players) {
+        player.setDead(true);
+    }
+
+    board.reset();
+
+    for (int i = 0; i < numPlayers; i++) {
+        resetPlayer(i);
+    }
+}
+
+void Game::getActionMasks(Player &player, int &safe, int &danger)
+{
+    Tile head = player.getHead();
+    safe = 0;
+    danger = 0;
+
+    for (int i = 0; i < 6; i++) {
+        Tile target = getNeighbor(head, i);
+        int owner = board.getOwner(target);
+
+        if (owner == BORDER_TILE) continue;
+
+        safe |= 1 << i;
+
+        if (owner == player.getId()) continue;
+
+        for (auto &other : players) {
+            if (other == player || other.isDead()) continue;
+
+            if (hexDistance(target, other.getHead()) <= 1) {
+                danger |= 1 << i;
+                break;
+            }
+        }
+    }
+
+    // the trail is checked before the new head is claimed, so it is the same for all directions
+    for (auto &other : players) {
+        if (other == player || other.isDead()) continue;
+
+        for (auto &tile : player.getClaim()) {
+            if (hexDistance(tile, other.getHead()) <= 1) {
+                danger = safe;
+                return;
+            }
+        }
+    }
+}
+
+bool Game::isSpawnPointSafe(Player &player, Tile spawnPoint)
+{
+    for (auto &other : players) {
+        if (other == player || other.isDead()) continue;
+
+        if (hexDistance(spawnPoint, other.getHead()) <= SPAWN_HEAD_DISTANCE) {
+            return false;
+        }
+
+        // claims are not on the board, the spawn area must not cut a tail
+        for (auto &tile : other.getClaim()) {
+            if (hexDistance(spawnPoint, tile) <= SPAWN_CLEARANCE) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+Tile Game::findSpawnPoint(Player &player)
+{
+    Tile spawnPoint;
+
+    // the free areas do not know the heads and claims, draw again if one is close
+    for (int i = 0; i < SPAWN_ATTEMPTS && board.getFreeSpawnTile(rng, spawnPoint); i++) {
+        if (isSpawnPointSafe(player, spawnPoint)) {
+            return spawnPoint;
+        }
+    }
+
+    // crowded board: all spawn centres from a random one, until one costs nothing
+    int numCenters = board.getNumSpawnTiles();
+    int start = rng.nextInt(numCenters);
+    int bestCost = INT_MAX;
+
+    for (int i = 0; i < numCenters && bestCost > 0; i++) {
+        Tile center = board.getSpawnTile((start + i) % numCenters);
+        int cost = getSpawnCost(player, center);
+
+        if (cost < bestCost) {
+            spawnPoint = center;
+            bestCost = cost;
+        }
+    }
+
+    return spawnPoint;
 }
 
-void Game::approveCaptures(Player &player, unordered_set<Tile> tiles)
+int Game::getSpawnCost(Player &player, Tile spawnPoint)
+{
+    vector<Tile> area = hexArea(spawnPoint, SPAWN_AREA_RADIUS);
+    int taken = 0;
+    int killed = 0;
+
+    for (unsigned long i = 0; i < area.size(); i++) {
+        int ownerId = board.getOwner(area[i]);
+        if (ownerId < 0 || ownerId == player.getId()) continue;
+
+        taken++;
+
+        // every owner is counted at its first tile in the area
+        int lost = 0;
+        bool first = true;
+
+        for (unsigned long j = 0; j < area.size(); j++) {
+            if (board.getOwner(area[j]) == ownerId) {
+                lost++;
+                first = first && j >= i;
+            }
+        }
+
+        if (first && getPlayer(ownerId).getNumCaptures() <= lost) {
+            killed++;
+        }
+    }
+
+    // taken is at most the size of the area, so it never outweighs the others
+    int unsafe = isSpawnPointSafe(player, spawnPoint) ? 0 : 1;
+    int weight = area.size() + 1;
+
+    return (killed * 2 + unsafe) * weight + taken;
+}
+
+template<typename Tiles>
+void Game::approveCaptures(Player &player, const Tiles &tiles)
 {
     for (auto &tile : tiles) {
         // get the previous owner of the tile
@@ -67,59 +264,144 @@ void Game::approveCaptures(Player &player, unordered_set<Tile> tiles)
                 // that player was surrounded completely
                 setDead(prevOwner);
                 player.addKill();
+                addEvent(EVENT_KILLED, player, prevOwnerId, CAUSE_SURROUNDED);
             }
         }
 
+        capturesFrom[prevOwnerId + 1]++;
         board.setOwner(tile, player);
     }
 
     player.addCaptures(tiles.size());
 }
 
-void Game::takeActions(vector<float> actions)
+void Game::addCaptureEvents(Player &player)
 {
-    // do all the moves
-    for (auto &player : players) {
-        if (player.isDead()) continue;
+    for (int i = 0; i <= numPlayers; i++) {
+        if (capturesFrom[i] > 0) {
+            addEvent(EVENT_CAPTURED, player, i - 1, capturesFrom[i]);
+            capturesFrom[i] = 0;
+        }
+    }
+}
+
+template<typename T>
+void Game::takeActions(const T *actions)
+{
+    events.clear();
+
+    // the only branch on the movement, the moves themselves are specialized
+    switch (movement) {
+        case MOVE_TILES: move<MOVE_TILES>(actions); break;
+        case MOVE_FREE: move<MOVE_FREE>(actions); break;
+        default: move<MOVE_HEADINGS>(actions);
+    }
+}
+
+template<int Movement, typename T>
+void Game::move(const T *actions)
+{
+    int numSubsteps = 1;
+
+    if constexpr (Movement == MOVE_FREE) {
+        float maxLength = 0;
+
+        for (auto &player : players) {
+            if (player.isDead()) continue;
+
+            int id = player.getId();
+            moveStarts[id] = player.getPosition();
+            moveEnds[id] = calcContinuousStep(player, (float) actions[id]);
+            maxLength = max(maxLength, distance(moveStarts[id], moveEnds[id]));
+        }
+
+        numSubsteps = max(1, (int) ceil(maxLength / MAX_SUBSTEP_LENGTH));
+    } else if constexpr (Movement == MOVE_HEADINGS) {
+        int32_t maxLength = 0;
+
+        for (auto &player : players) {
+            if (player.isDead()) continue;
+
+            int id = player.getId();
+            FixedCoord start = player.getFixedPosition();
+            FixedCoord heading = headings[toHeading((float) actions[id])];
+            int64_t velocity = player.getFixedVelocity();
+
+            fixedMoveStarts[id] = start;
+            fixedMoveEnds[id] = FixedCoord{(int32_t) (start.x + ((heading.x * velocity) >> FIXED_SHIFT)),
+                                           (int32_t) (start.y + ((heading.y * velocity) >> FIXED_SHIFT))};
+            maxLength = max(maxLength, (int32_t) velocity);
+        }
 
-        CartCoord newPos = calcStep(player, actions[player.getId()]);
-        player.setPosition(newPos);
+        const int32_t maxSubstepLength = (int32_t) (MAX_SUBSTEP_LENGTH * FIXED_ONE);
+        numSubsteps = max(1, (maxLength + maxSubstepLength - 1) / maxSubstepLength);
     }
 
-    checkBorderCollisions();
+    for (int i = 1; i <= numSubsteps; i++) {
+        // players which died in an earlier substep stay where they are
+        for (auto &player : players) {
+            if (player.isDead()) continue;
+
+            int id = player.getId();
+
+            if constexpr (Movement == MOVE_TILES) {
+                player.setHead(getNeighbor(player.getHead(), (int) actions[id]));
+            } else if constexpr (Movement == MOVE_FREE) {
+                CartCoord start = moveStarts[id];
+                CartCoord end = moveEnds[id];
+                float fraction = (float) i / numSubsteps;
+
+                player.setPosition(i == numSubsteps
+                    ? end
+                    : CartCoord{start.x + fraction * (end.x - start.x), start.y + fraction * (end.y - start.y)});
+            } else {
+                FixedCoord start = fixedMoveStarts[id];
+                FixedCoord end = fixedMoveEnds[id];
+
+                player.setFixedPosition(FixedCoord{
+                    (int32_t) (start.x + (int64_t) (end.x - start.x) * i / numSubsteps),
+                    (int32_t) (start.y + (int64_t) (end.y - start.y) * i / numSubsteps)
+                });
+            }
+        }
 
-    if (numPlayers > 1) {
-        checkCollisions();
+        checkBorderCollisions();
+
+        if (numPlayers > 1) {
+            checkCollisions();
+        }
+
+        checkTileCaptures();
     }
+}
+
+#define INSTANTIATE_TAKE_ACTIONS(T) template void Game::takeActions<T>(const T *actions);
+FOR_EACH_ACTION_TYPE(INSTANTIATE_TAKE_ACTIONS)
 
-    checkTileCaptures();
+int Game::toHeading(float direction)
+{
+    int heading = (int) lround((direction - firstHeading) * (float) (numHeadings / (2 * M_PI))) % numHeadings;
+    return heading < 0 ? heading + numHeadings : heading;
 }
 
-CartCoord Game::calcStep(Player &player, float direction)
+CartCoord Game::calcContinuousStep(Player &player, float direction)
 {
     CartCoord position = player.getPosition();
 
-    if (discrete) {
-        int dir = (int) direction;
-        Tile pos = hexToTile(cartToHex(position));
-        Tile newPos = getNeighbor(pos, dir);
-        position = hexToCart(tileToHex(newPos));
-    } else {
-        // calculate the new player position
-        //float alpha = direction * 2. * M_PI;
+    // calculate the new player position
+    //float alpha = direction * 2. * M_PI;
 
-        // direction vector of length 1
-        float x = -sin(direction);
-        float y = cos(direction);
+    // direction vector of length 1
+    float x = -sin(direction);
+    float y = cos(direction);
 
-        // vector scaled by velocity
-        x *= player.getVelocity();
-        y *= player.getVelocity();
+    // vector scaled by velocity
+    x *= player.getVelocity();
+    y *= player.getVelocity();
 
-        // apply the change
-        position.x += x;
-        position.y += y;
-    }
+    // apply the change
+    position.x += x;
+    position.y += y;
 
     return position;
 }
@@ -134,6 +416,7 @@ void Game::checkBorderCollisions()
 
         if (board.getOwner(head) == BORDER_TILE) {
             setDead(player);
+            addEvent(EVENT_DIED, player, -1, CAUSE_BORDER);
         }
     }
 }
@@ -146,12 +429,18 @@ void Game::checkTileCaptures()
         Tile head = player.getHead();
         
         if (!board.isOwner(head, player)) {
+            // continuous players stay on a tile for several substeps
+            if (!player.hasClaimed(head)) {
+                addEvent(EVENT_CLAIMED, player, -1, 0, head);
+            }
+
             player.claim(head);
         } else if (player.hasAnyClaim()) {
             // approve claim
             approveCaptures(player, player.getClaim());
             player.approveClaim();
             approveCaptures(player, board.getInclusions(player));
+            addCaptureEvents(player);
             checkHasCapturedAll(player);
         } 
     }
@@ -172,14 +461,18 @@ void Game::checkCollisions()
                     // other dies
                     player.addKill();
                     setDead(other);
+                    addEvent(EVENT_KILLED, player, other.getId(), CAUSE_HEAD);
                 } else if (ownerId == other.getId()) {
                     // player dies
                     other.addKill();
                     setDead(player);
+                    addEvent(EVENT_KILLED, other, player.getId(), CAUSE_HEAD);
                 } else {
                     // both die
                     setDead(player);
                     setDead(other);
+                    addEvent(EVENT_DIED, player, other.getId(), CAUSE_HEAD);
+                    addEvent(EVENT_DIED, other, player.getId(), CAUSE_HEAD);
                 }
 
             } else if (other.hasClaimed(player.getHead()) && player.hasClaimed(other.getHead())) {
@@ -198,16 +491,20 @@ void Game::checkCollisions()
 
                 if (player.isDead() && !other.isDead()) {
                     other.addKill();
-                }
-
-                if (other.isDead() && !player.isDead()) {
+                    addEvent(EVENT_KILLED, other, player.getId(), CAUSE_SWAP);
+                } else if (other.isDead() && !player.isDead()) {
                     player.addKill();
+                    addEvent(EVENT_KILLED, player, other.getId(), CAUSE_SWAP);
+                } else if (player.isDead() && other.isDead()) {
+                    addEvent(EVENT_DIED, player, other.getId(), CAUSE_SWAP);
+                    addEvent(EVENT_DIED, other, player.getId(), CAUSE_SWAP);
                 }
                 
             } else if (other.hasClaimed(player.getHead())) { // head - tail
                 // player kills other
                 player.addKill();
                 setDead(other);
+                addEvent(EVENT_KILLED, player, other.getId(), CAUSE_TAIL);
             }
         }
     }
@@ -215,7 +512,43 @@ void Game::checkCollisions()
 
 void Game::checkHasCapturedAll(Player &player)
 {
-    if (player.getNumCaptures() == board.getNumTiles()) {
+    if (player.getNumCaptures() == board.getNumTiles() && !player.isWinner()) {
         player.setWinner(true);
+        addEvent(EVENT_WON, player);
+    }
+}
+
+void Game::snapshot(SnapshotWriter &writer)
+{
+    writer.write(numPlayers);
+    writer.write(mapRadius);
+    writer.write(movement);
+    writer.write(numHeadings);
+    writer.write(rng);
+    board.snapshot(writer);
+
+    for (auto &player : players) {
+        player.snapshot(writer);
+    }
+}
+
+bool Game::restore(SnapshotReader &reader)
+{
+    if (!reader.expect(numPlayers) || !reader.expect(mapRadius)
+        || !reader.expect(movement) || !reader.expect(numHeadings)) {
+        return false;
+    }
+
+    reader.read(rng);
+    board.restore(reader, numPlayers);
+
+    if (!reader.isDryRun()) {
+        events.clear();
     }
+
+    for (auto &player : players) {
+        player.restore(reader, mapRadius);
+    }
+
+    return !reader.hasFailed();
 }
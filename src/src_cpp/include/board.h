@@ -1,18 +1,47 @@
 #ifndef HEXAR_BOARD_H
 #define HEXAR_BOARD_H
 
-#include <unordered_map>
+#include <vector>
 #include <unordered_set>
 #include "definitions.h"
 #include "player.h"
+#include "random.h"
 
 
+/**
+ * the owner of every tile, stored in a flat array over the axial
+ * coordinates -radius .. radius. Tiles outside of it are free.
+ *
+ * The board also keeps the spawn centres whose spawn area (hexArea of
+ * radius 2) and its surrounding ring are completely free, so a spawn
+ * point that does not overlap any territory is drawn in O(1).
+ * Every change of a tile between free and owned updates the free
+ * centres around it.
+ */
 class Board
 {
 private:
     const int radius;
     const int numTiles;
-    std::unordered_map<Tile, int> tiles;
+    const int width;
+    std::vector<int> owners;
+
+    // spawn centres: tiles within radius-3 of the center, as flat indices
+    std::vector<int> spawnCenters;
+
+    // per flat index: number of owned tiles within SPAWN_CLEARANCE of a spawn centre,
+    // and the position of a free spawn centre in freeSpawnCenters (-1 if it is not free)
+    std::vector<int> numBlocking;
+    std::vector<int> freeSpawnIndex;
+    std::vector<int> freeSpawnCenters;
+
+    // the tiles within SPAWN_CLEARANCE of CENTER
+    std::vector<Tile> clearanceArea;
+
+    bool contains(Tile t);
+    int index(Tile t);
+    Tile tileAt(int index);
+    void updateSpawnCenters(Tile t, int change);
 
 public:
     explicit Board(int radius);
@@ -21,7 +50,20 @@ public:
     int getNumTiles();
     int getOwner(Tile t);
     std::unordered_set<Tile> getAll();
-    Tile getRandomTile();
+
+    /**
+     * the spawn centres 0 .. getNumSpawnTiles() - 1, regardless of the tiles around them
+     */
+    int getNumSpawnTiles();
+    Tile getSpawnTile(int i);
+
+    /**
+     * draws a spawn centre whose surroundings are free, see Board.
+     * Returns false if there is none.
+     */
+    bool getFreeSpawnTile(Rng &rng, Tile &tile);
+    int getNumFreeSpawnTiles();
+
     void setFree(Tile tile);
     void setOwner(Tile t, Player &player);
     void setOwner(const std::vector<Tile> &tiles, Player &player);
@@ -29,8 +71,20 @@ public:
     bool isValid(Tile tile);
     bool isOwner(Tile tile, Player &player);
     std::unordered_set<Tile> getAllByOwner(Player &player);
+
+    /**
+     * frees the territory of player, which lies within its bounding box
+     */
     int freeAllByOwner(Player &player);
     std::unordered_set<Tile> getInclusions(Player &player);
+
+    /**
+     * writes / reads the owners and the free spawn centres, see Game::snapshot.
+     * A dry run fails for owners which are no player of the numPlayers
+     * and for free spawn centres which do not match the owners.
+     */
+    void snapshot(SnapshotWriter &writer);
+    void restore(SnapshotReader &reader, int numPlayers);
 };
 
 
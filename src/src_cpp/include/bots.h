@@ -0,0 +1,144 @@
+#ifndef HEXAR_BOTS_H
+#define HEXAR_BOTS_H
+
+#include "game.h"
+
+
+/**
+ * a scripted opponent, stepped by the Controller in place of an agent.
+ * act is called once per step for a living player and returns the
+ * direction (0 .. 5, see DIRECTIONS) the player moves to.
+ * Bots only change their plan when the player reaches a new tile,
+ * which makes them usable with continuous movement as well.
+ */
+class Bot
+{
+private:
+    Tile lastHead;
+    int lastDirection;
+
+protected:
+    /**
+     * the direction to take from the new tile head
+     */
+    virtual int chooseDirection(Game &game, Player &player) = 0;
+
+    /**
+     * a direction is safe if it does not lead onto the border.
+     * Own claims do not kill in this game.
+     */
+    static bool isSafe(Game &game, Tile head, int direction);
+    static int randomSafeDirection(Game &game, Tile head);
+
+    /**
+     * the safe direction which brings head closest to target
+     */
+    static int directionTowards(Game &game, Tile head, Tile target);
+
+public:
+    Bot();
+    virtual ~Bot();
+
+    virtual int act(Game &game, Player &player);
+
+    /**
+     * forgets the current plan, called when the player is respawned
+     */
+    virtual void reset();
+
+    /**
+     * writes / reads the plan of the bot, see Controller::snapshot
+     */
+    virtual void snapshot(SnapshotWriter &writer);
+    virtual void restore(SnapshotReader &reader);
+
+    /**
+     * creates a bot of type BOT_RANDOM, BOT_GRABBER, BOT_HUNTER or BOT_DEFENSIVE,
+     * returns nullptr for BOT_NONE or an unknown type
+     */
+    static Bot *create(int type);
+
+    /**
+     * the continuous action which moves along direction
+     */
+    static float toAngle(int direction);
+};
+
+/**
+ * moves to a random direction in every step, but never onto the border
+ */
+class RandomBot : public Bot
+{
+protected:
+    int chooseDirection(Game &game, Player &player) override;
+
+public:
+    int act(Game &game, Player &player) override;
+};
+
+/**
+ * leaves its territory for a loop: legLength tiles straight, legLength
+ * tiles after a turn, then back home on the shortest way
+ */
+class GrabberBot : public Bot
+{
+private:
+    const int minLegLength;
+    const int maxLegLength;
+
+    int leg;
+    int tilesInLeg;
+    int legLength;
+    int outDirection;
+    int turn;
+    Tile home;
+
+protected:
+    int chooseDirection(Game &game, Player &player) override;
+
+    /**
+     * ends the current loop, the player heads home from its next tile on
+     */
+    void returnHome();
+
+public:
+    explicit GrabberBot(int minLegLength = 2, int maxLegLength = 5);
+    void reset() override;
+    void snapshot(SnapshotWriter &writer) override;
+    void restore(SnapshotReader &reader) override;
+};
+
+/**
+ * heads for the nearest claimed tile of another player within
+ * huntRadius, grabs territory like GrabberBot if there is none
+ */
+class HunterBot : public GrabberBot
+{
+private:
+    const int huntRadius;
+
+protected:
+    int chooseDirection(Game &game, Player &player) override;
+
+public:
+    explicit HunterBot(int huntRadius = 8);
+};
+
+/**
+ * grabs territory in small loops and returns home as soon as
+ * another player gets within dangerRadius of its head
+ */
+class DefensiveBot : public GrabberBot
+{
+private:
+    const int dangerRadius;
+
+protected:
+    int chooseDirection(Game &game, Player &player) override;
+
+public:
+    explicit DefensiveBot(int dangerRadius = 4);
+};
+
+
+#endif //HEXAR_BOTS_H
@@ -1,8 +1,18 @@
 #ifndef HEXAR_INTERFACE_H
 #define HEXAR_INTERFACE_H
 
+#include <vector>
+#include <string>
+#include <mutex>
 #include "game.h"
-#include "renderer.h"
+#include "bots.h"
+#include "thread_pool.h"
+
+// the renderers are only known to controller.cc, so the game core
+// does not depend on SDL
+class ObservationRenderer;
+class DemoRenderer;
+class Recorder;
 
 
 class Controller {
@@ -15,23 +25,74 @@ private:
     const int observationRadius;
     const int pxObservationWidth;
     const int pxObservationHeight;
+    const int pxSupersampling;
+    const int numRenderThreads;
+    const bool sharedGlobalRender;
+    const RewardWeights rewardWeights;
+    const int maxSteps;
+    const bool autoReset;
+    const std::vector<int> botTypes;
 
     Game game;
-    ObservationRenderer *observationRenderer;
+
+    // number of steps every player has taken since its last respawn
+    std::vector<int> takenSteps;
+
+    // players which were respawned at the end of the last step
+    std::vector<char> respawned;
+
+    // the native opponent of every player slot, nullptr for agents.
+    // Their actions replace those passed to takeActions, merged in actionBuffer
+    std::vector<Bot *> bots;
+    std::vector<double> actionBuffer;
+    bool hasBots;
+
+    // reused by snapshot
+    std::vector<char> snapshotBuffer;
+
+    // counters of every player from before the current step, for the rewards
+    std::vector<int> prevCaptures;
+    std::vector<int> prevClaims;
+    std::vector<int> prevKills;
+
+    // one observation renderer per render thread, renderers are never
+    // shared between threads. They are created on first use, so feature
+    // observations never touch SDL.
+    std::vector<ObservationRenderer *> observationRenderers;
+    ThreadPool *renderPool;
+
+    // with sharedGlobalRender, global pixel observations are coloured 
+    // from one semantic frame, rendered at most once per step
+    ObservationRenderer *semanticRenderer;
+    bool semanticFrameValid;
     DemoRenderer *windowRenderer;
+    Recorder *recorder;
+
+    std::mutex callMutex;
 
     // the old ones
     //void getPixelObservation(Player &player, float *obsMemAddr, long int size);
     //void getFeatureObservation(Player &player, float *obsMemAddr, long int size);
 
     // the new ones
-    void getLocalPixelObservation(Player &player, float *obsMemAddr, long int size);
-    void getGlobalPixelObservation(Player &playerm, float *obsMemAddr, long int size);
+    void getObservation(int playerId, ObservationRenderer *renderer, float *obsMemAddr, long int size);
+    void getLocalPixelObservation(Player &player, ObservationRenderer *renderer, float *obsMemAddr, long int size);
+    void getGlobalPixelObservation(Player &player, ObservationRenderer *renderer, float *obsMemAddr, long int size);
     void getLocalFeatureObservation(Player &player, float *obsMemAddr, long int size);
     void getGlobalFeatureObservation(Player &player, float *obsMemAddr, long int size);
 
+    /**
+     * reads the game, the step counters and the bots, with a dry run reader
+     * this only checks the snapshot. Returns false if it does not match.
+     */
+    bool restore(SnapshotReader &reader);
+
     float getFeatureObservationCode(Player &player, Tile tile);
 
+    void createObservationRenderers();
+    float getGlobalPixelScale();
+    void prepareSemanticFrame();
+
 public:
     Controller(int mapRadius,
                int numPlayers,
@@ -41,28 +102,162 @@ public:
                int observationRadius,
                int pxObservationWidth,
                int pxObservationHeight,
-               float defaultVelocity);
+               float defaultVelocity,
+               int pxSupersampling = OBS_SUPERSAMPLING,
+               int numRenderThreads = 1,
+               bool sharedGlobalRender = false,
+               RewardWeights rewardWeights = DEFAULT_REWARD_WEIGHTS,
+               int maxSteps = DEFAULT_MAX_STEPS,
+               bool autoReset = false,
+               const std::vector<int> &botTypes = std::vector<int>(),
+               uint64_t seed = 0,
+               int numHeadings = 0);
 
     ~Controller();
+
+    /**
+     * respawns one player, ids which are no player are refused
+     */
     void resetPlayer(int playerId);
+
+    /**
+     * respawns all players, see Game::resetAll
+     */
+    void resetAll();
+
+    /**
+     * see Game::seed
+     */
+    void seed(uint64_t seed);
+
+    /**
+     * serializes the game (see Game::snapshot), the step counters and the
+     * plans of the bots. The returned buffer is reused by the next snapshot.
+     */
+    const std::vector<char> &snapshot();
+
+    /**
+     * restores a snapshot of a controller with the same configuration
+     * (game, movement and bots), the following steps are exactly the same
+     * as after the snapshot. Returns false if the snapshot does not match or
+     * holds values out of range, nothing is changed then.
+     */
+    bool restore(const char *data, size_t size);
+
+    /**
+     * like restore, but skips checking the snapshot. Only for snapshots
+     * which were restored successfully before, e.g. the root state of
+     * Mcts, which is restored once per simulation.
+     */
+    void restoreTrusted(const char *data, size_t size);
+
+    /**
+     * a new controller of the same configuration and in the same state,
+     * without render threads, window or recording. Used by the workers of Mcts.
+     */
+    Controller *clone();
     void printInfo();
-    void takeActions(std::vector<float> actions);
+    /**
+     * actions holds one action per player, see Game::takeActions.
+     * The entries of players driven by a bot (see botTypes) are ignored.
+     */
+    template<typename T>
+    void takeActions(const T *actions);
+
+    /**
+     * takes the actions of all players and writes the reward and the done
+     * flag of every player to rewards and dones (numPlayers entries each).
+     * A player is done if it died, won or has taken maxSteps steps since
+     * its last respawn. Dead players only get the timestep reward.
+     */
+    template<typename T>
+    void takeActions(const T *actions, float *rewards, bool *dones);
+
+    /**
+     * a whole environment step: takeActions with rewards and dones, then
+     * the info records of all players (see getInfo). With autoReset, done 
+     * players are respawned afterwards, their records still hold the values
+     * from before the respawn and have the reset flag set.
+     */
+    template<typename T>
+    void step(const T *actions, float *rewards, bool *dones, int infoFields, char *info);
     bool isDead(int playerId);
     bool isWinner(int playerId);
     int getNumKills(int playerId);
     int getNumCaptures(int playerId);
     int getNumClaims(int playerId);
+    int getNumPlayers();
+
+    /**
+     * number of steps the player has taken since its last respawn,
+     * 0 for ids which are no player
+     */
+    int getTakenSteps(int playerId);
+
+    /**
+     * size in bytes of one info record holding the INFO_* fields set in infoFields
+     */
+    static long int getInfoRecordSize(int infoFields);
+
+    /**
+     * writes one packed info record per player to out, see INFO_KILLS.
+     * Only the selected fields are computed.
+     */
+    void getInfo(int infoFields, char *out);
     std::vector<float> getDistancesToBorder(int playerId);
 
+    /**
+     * writes the safe and dangerous actions of the players 0 .. numAgents-1
+     * to safe and danger, see Game::getActionMasks. Dead players may take
+     * any action, all bits are safe for them.
+     */
+    void getActionMasks(int numAgents, unsigned char *safe, unsigned char *danger);
+
     /**
      * show
      * returns true if a quit event was fired from the demo window
      */
     bool show();
+
+    /**
+     * records the demo view of every following step in the background,
+     * see Recorder. Returns false if the output cannot be opened.
+     */
+    bool startRecording(const std::string &path, int format, int width, int height, int queueSize);
+
+    /**
+     * finishes the recording, returns false if there was none
+     */
+    bool stopRecording(long &numWritten, long &numDropped);
     void getObservation(int playerId, float *obsMemAddr, long int size);
+
+    /**
+     * writes the observations of the players 0 .. numAgents-1 one after
+     * another to obsMemAddr. The observations are generated in parallel
+     * if the controller has more than one render thread.
+     */
+    void getObservations(int numAgents, float *obsMemAddr, long int size);
     long int getObservationSize();
 
     bool isPerspectiveLocal();
+    bool isActionSpaceDiscrete();
+    Game &getGame();
+
+    /**
+     * true if the player is driven by a bot, see botTypes.
+     * False for ids which are no player.
+     */
+    bool isBot(int playerId);
+
+    /**
+     * a controller must only be used by one thread at a time, this mutex
+     * is locked by py_module around every call. Different controllers can
+     * be used from different threads in parallel, pixel observations
+     * included: every renderer fills polygons with its own buffer instead
+     * of the global one of SDL2_gfx. Only show must be called from the
+     * main thread.
+     */
+    std::mutex &getMutex();
 };
 
 
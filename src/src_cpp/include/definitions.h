@@ -2,8 +2,14 @@
 #define HEXAR_DEFINITIONS_H
 
 #include <cmath>
+#include <cstdint>
 #include <functional>
+
+// HEXARIO_HEADLESS builds the game core and the feature observations
+// without any dependency on SDL, see setup.py
+#ifndef HEXARIO_HEADLESS
 #include <SDL2/SDL.h>
+#endif
 
 
 typedef struct Tile {
@@ -49,14 +55,37 @@ typedef struct {
     float x, y, z;
 } CubeCoord;
 
+/**
+ * cartesian position in units of 1 / FIXED_ONE,
+ * used by the quantized continuous movement, see Game
+ */
 typedef struct {
-    Sint16 x, y;
-} ScreenCoord;
+    int32_t x, y;
+} FixedCoord;
 
 typedef struct {
     Tile min, max;
 } TileBoundingBox;
 
+/**
+ * something that happened in a step, see Game::getEvents and the EVENT_* types
+ * for the meaning of the fields. Unused fields are -1 (other) or 0.
+ */
+typedef struct {
+    int32_t type;
+    int32_t player;
+    int32_t other;
+    int32_t value;
+    int32_t q, r;
+} GameEvent;
+
+/**
+ * weights of the reward terms, see VectorController
+ */
+typedef struct {
+    float timestep, capture, claim, kill;
+} RewardWeights;
+
 const Tile DIRECTIONS[6] = {
         Tile{1, 0},
         Tile{1, -1},
@@ -72,14 +101,103 @@ const float TILE_UNIT_SIZE = 1.0;
 const float CLAIMED_TILE_UNIT_SIZE = 0.7;
 const float PLAYER_PATH_WIDTH = 0.5;
 
+const int FIXED_SHIFT = 16;
+const int32_t FIXED_ONE = 1 << FIXED_SHIFT;
+
+// continuous moves longer than this are split into substeps, which are checked
+// like whole steps. Tiles which are not adjacent are at least one side length
+// (TILE_UNIT_SIZE) apart, so a substep never skips a tile
+const float MAX_SUBSTEP_LENGTH = 0.5 * TILE_UNIT_SIZE;
+
 const int FREE_TILE = -1;
 const int BORDER_TILE = -2;
 
+// players spawn on hexArea(spawn point, SPAWN_AREA_RADIUS). Spawn points are
+// chosen so that all tiles within SPAWN_CLEARANCE are free and no other head
+// is within SPAWN_HEAD_DISTANCE, as long as there is such a point
+const int SPAWN_AREA_RADIUS = 2;
+const int SPAWN_CLEARANCE = 2;
+const int SPAWN_HEAD_DISTANCE = 4;
+const int SPAWN_ATTEMPTS = 8;
+
 const int WIN_WIDTH  = 800;
 const int WIN_HEIGHT = 600;
 const int WIN_SCALE  = 10;
 
+const int RECORDING_Y4M = 0;
+const int RECORDING_PPM = 1;
+const int RECORDING_FPS = 30;
+const int RECORDING_DEFAULT_QUEUE_SIZE = 64;
+
+const RewardWeights DEFAULT_REWARD_WEIGHTS = RewardWeights{0.0, 1.0, 0.0, 100.0};
+const int DEFAULT_MAX_STEPS = 500;
+
+// native opponents which can take a player slot, see bots.h
+const int BOT_NONE      = 0;
+const int BOT_RANDOM    = 1;
+const int BOT_GRABBER   = 2;
+const int BOT_HUNTER    = 3;
+const int BOT_DEFENSIVE = 4;
+
+// the types of GameEvent:
+// claimed: player claimed the tile q, r
+// captured: player captured value tiles which were owned by other (FREE_TILE if free)
+// killed: player killed other, value is the cause
+// died: player died without a killer, value is the cause, other the player involved (or -1)
+// won: player captured the whole map
+const int EVENT_CLAIMED  = 0;
+const int EVENT_CAPTURED = 1;
+const int EVENT_KILLED   = 2;
+const int EVENT_DIED     = 3;
+const int EVENT_WON      = 4;
+
+// the causes of killed and died events: heads on the same tile, heads swapped,
+// head on the trail, surrounded by a capture, head on the border, territory
+// taken by the spawn area of a respawned player
+const int CAUSE_HEAD       = 0;
+const int CAUSE_SWAP       = 1;
+const int CAUSE_TAIL       = 2;
+const int CAUSE_SURROUNDED = 3;
+const int CAUSE_BORDER     = 4;
+const int CAUSE_SPAWN      = 5;
+
+// fields of the per player info records, combined as bitmask.
+// The records are packed in this order: kills, captures, claims (int32),
+// coverage (float32), winner, dead (bool), distances (6 x float32),
+// steps since the last respawn (int32), respawned by auto reset (bool)
+const int INFO_KILLS     = 1 << 0;
+const int INFO_CAPTURES  = 1 << 1;
+const int INFO_CLAIMS    = 1 << 2;
+const int INFO_COVERAGE  = 1 << 3;
+const int INFO_WINNER    = 1 << 4;
+const int INFO_DEAD      = 1 << 5;
+const int INFO_DISTANCES = 1 << 6;
+const int INFO_STEPS     = 1 << 7;
+const int INFO_RESET     = 1 << 8;
+const int INFO_ALL       = (1 << 9) - 1;
+
+// the element types of the action arrays py_module reads in place
+// (int8, int32, int64 as long or long long, float32, float64).
+// Expands INSTANTIATE(type) for each of them, for explicit template instantiations
+#define FOR_EACH_ACTION_TYPE(INSTANTIATE) \
+    INSTANTIATE(signed char) \
+    INSTANTIATE(int) \
+    INSTANTIATE(long) \
+    INSTANTIATE(long long) \
+    INSTANTIATE(float) \
+    INSTANTIATE(double)
+
 const int OBS_SCALE  = 10;
+const int OBS_SUPERSAMPLING = 1;
+
+// very very important constant :D
+const double SQRT3 = sqrt(3.0);
+
+#ifndef HEXARIO_HEADLESS
+
+typedef struct {
+    Sint16 x, y;
+} ScreenCoord;
 
 const SDL_Color COLOR_WHITE = SDL_Color{255, 255, 255, 255};
 const SDL_Color COLOR_RED   = SDL_Color{255, 0, 0, 255};
@@ -90,9 +208,6 @@ const SDL_Color COLOR_DEMO_BACKGROUND = SDL_Color{230, 230, 230, 255};
 const SDL_Color COLOR_BORDER = COLOR_RED;
 const SDL_Color COLOR_INVALID = COLOR_DEMO_BACKGROUND;
 
-// very very important constant :D
-const double SQRT3 = sqrt(3.0);
-
 const SDL_Color BLACK  = SDL_Color{0,0,0, 255};
 const SDL_Color GRAY   = SDL_Color{120, 120, 120, 255};
 const SDL_Color WHITE  = SDL_Color{255, 255, 255, 255};
@@ -127,5 +242,6 @@ const SDL_Color PLAYER_COLORS[] = {
     GRAY
 };
 
+#endif //HEXARIO_HEADLESS
 
 #endif //HEXAR_DEFINITIONS_H
@@ -0,0 +1,105 @@
+#ifndef HEXAR_ENVSERVER_H
+#define HEXAR_ENVSERVER_H
+
+#include <string>
+#include <cstdint>
+#include "vector_controller.h"
+
+// commands of the control socket
+const int32_t SERVER_RESET = 0;
+const int32_t SERVER_STEP  = 1;
+const int32_t SERVER_CLOSE = 2;
+
+// status of the replies
+const int32_t SERVER_OK    = 0;
+const int32_t SERVER_ERROR = -1;
+
+const int64_t SERVER_MAGIC = 0x6865786172696f31; // "hexario1"
+const int SERVER_ALIGNMENT = 64;
+
+/**
+ * a command sent to the server, and its reply with command replaced by the status
+ */
+typedef struct {
+    int32_t command;
+    int32_t slot;
+} ServerMessage;
+
+/**
+ * layout of the shared memory segment, stored at its beginning.
+ * The segment holds numSlots slots of slotSize bytes from slotsOffset on,
+ * each with the arrays of all environments of all workers:
+ * actions (float32), observations (float32), rewards (float32),
+ * dones (bool) and the info records. The offsets are relative to the slot.
+ */
+typedef struct {
+    int64_t magic;
+    int64_t numSlots;
+    int64_t numEnvs;
+    int64_t numAgents;
+    int64_t observationSize;
+    int64_t infoFields;
+    int64_t infoRecordSize;
+    int64_t slotsOffset;
+    int64_t slotSize;
+    int64_t actionsOffset;
+    int64_t observationsOffset;
+    int64_t rewardsOffset;
+    int64_t donesOffset;
+    int64_t infoOffset;
+} ServerLayout;
+
+
+/**
+ * serves the environments of one VectorController to a client process.
+ * Several servers share one segment, every server owns the environments
+ * envOffset .. envOffset + vc.getNumEnvs() - 1 of each slot.
+ * The client writes the actions to a slot and sends the slot through the
+ * unix socket, the server steps its games with them and writes the results
+ * to the same slot before it replies. Nothing but the two ints of the
+ * messages is copied between the processes.
+ * POSIX only.
+ */
+class EnvServer {
+private:
+    VectorController &vc;
+    const std::string socketPath;
+    const std::string shmName;
+    const int envOffset;
+    ServerLayout layout;
+
+    char *memory;
+    long int memorySize;
+    int listenSocket;
+    bool failed;
+
+    bool handle(const ServerMessage &message);
+
+    char *getSlot(int slot);
+
+public:
+    /**
+     * opens (or creates) the segment shmName sized for numEnvs environments
+     * and binds a socket at socketPath
+     */
+    EnvServer(VectorController &vc, const std::string &socketPath, const std::string &shmName,
+              int numEnvs, int envOffset, int infoFields, int numSlots);
+
+    ~EnvServer();
+
+    /**
+     * computes the layout of a segment, which is the same for every server
+     */
+    static ServerLayout getLayout(int numSlots, int numEnvs, int numAgents, long int observationSize, int infoFields);
+
+    bool hasFailed();
+
+    /**
+     * accepts one client and handles its commands until it sends
+     * SERVER_CLOSE or disconnects. Blocks the calling thread.
+     */
+    void serve();
+};
+
+
+#endif //HEXAR_ENVSERVER_H
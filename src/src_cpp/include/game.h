@@ -2,23 +2,62 @@
 #define HEXAR_GAMESTATE_H
 
 #include <vector>
+#include <cmath>
 #include <unordered_set>
 
 #include "definitions.h"
 #include "utils.h"
 #include "board.h"
 #include "player.h"
+#include "random.h"
 
 
 class Game {
     private:
         const int numPlayers;
         const int mapRadius;
-        const bool discrete;
+        const int numHeadings;
+
+        // takeActions is specialized for each movement
+        enum {
+            MOVE_TILES,     // discrete, the heads move to neighbor tiles and no positions are kept
+            MOVE_FREE,      // continuous along any angle
+            MOVE_HEADINGS   // continuous along one of numHeadings headings, in fixed point
+        };
+        const int movement;
+        Rng rng;
         Board board;
         std::vector<Player> players;
 
-        CartCoord calcStep(Player &player, float direction);
+        // the positions before and after the continuous step of every player, see takeActions
+        std::vector<CartCoord> moveStarts;
+        std::vector<CartCoord> moveEnds;
+
+        // with numHeadings, the unit step of every heading and the moves in fixed point
+        std::vector<FixedCoord> headings;
+        float firstHeading;
+        std::vector<FixedCoord> fixedMoveStarts;
+        std::vector<FixedCoord> fixedMoveEnds;
+
+        // the events since the last step began, and the captured tiles per previous owner + 1
+        std::vector<GameEvent> events;
+        std::vector<int> capturesFrom;
+
+        void addEvent(int type, Player &player, int other = -1, int value = 0, Tile tile = Tile{0, 0});
+
+        /**
+         * moves every player, continuous moves in substeps of equal parts.
+         * All rules are checked after every part.
+         */
+        template<int Movement, typename T>
+        void move(const T *actions);
+
+        /**
+         * the nearest of the numHeadings headings to a direction in radians
+         */
+        int toHeading(float direction);
+
+        CartCoord calcContinuousStep(Player &player, float direction);
         void checkBorderCollisions();
         void checkTileCaptures();
         void checkCollisions();
@@ -29,19 +68,123 @@ class Game {
          */
         void checkHasCapturedAll(Player &player);
 
-        void approveCaptures(Player &player, std::unordered_set<Tile> tiles);
+        /**
+         * a spawn point on free tiles, away from the heads and claims of
+         * the other players, see SPAWN_CLEARANCE. On a crowded board, the
+         * spawn centre of the lowest getSpawnCost.
+         */
+        Tile findSpawnPoint(Player &player);
+        bool isSpawnPointSafe(Player &player, Tile spawnPoint);
+
+        /**
+         * how bad spawning at spawnPoint is for the others, in this order:
+         * the players killed by losing their last tiles to the spawn area,
+         * an unsafe spawn point (see isSpawnPointSafe) and the tiles taken.
+         * 0 for a safe spawn point whose spawn area is unowned.
+         */
+        int getSpawnCost(Player &player, Tile spawnPoint);
+
+        /**
+         * Tiles is the vector of claims or the set of inclusions
+         */
+        template<typename Tiles>
+        void approveCaptures(Player &player, const Tiles &tiles);
+
+        /**
+         * adds one captured event per previous owner counted in capturesFrom
+         */
+        void addCaptureEvents(Player &player);
         void setDead(Player &player);
         
     public:
-        Game(int numPlayers, int mapRadius, bool discrete, float velocity);
+        /**
+         * with numHeadings > 0, continuous directions are quantized to numHeadings
+         * evenly spaced headings. The players then move by precomputed steps in
+         * fixed point and their tiles are found with integer math, see fixedToTile.
+         */
+        Game(int numPlayers, int mapRadius, bool discrete, float velocity, uint64_t seed = 0, int numHeadings = 0);
         ~Game();
 
         Board &getBoard();
         Player &getPlayer(int playerId);
         std::vector<Player> &getPlayers();
+        int getNumHeadings();
+
+        /**
+         * what happened since the last step began: the step itself and the
+         * respawns after it, see GameEvent. Events which follow from each
+         * other are in that order, e.g. a kill by a capture before the capture.
+         */
+        const std::vector<GameEvent> &getEvents();
 
-        void takeActions(std::vector<float> actions);
+        /**
+         * the random numbers of this game, e.g. for the spawn points and the bots
+         */
+        Rng &getRng();
+
+        /**
+         * restarts the random numbers, the following respawns depend only on seed
+         */
+        void seed(uint64_t seed);
+
+        /**
+         * actions holds one action per player and is read in place. Instantiated
+         * for FOR_EACH_ACTION_TYPE, discrete actions are never converted to float.
+         * Continuous moves longer than MAX_SUBSTEP_LENGTH are swept: the players
+         * move in substeps and claims, collisions and captures are checked for
+         * each of them, so a high velocity skips no tiles.
+         */
+        template<typename T>
+        void takeActions(const T *actions);
+
+        /**
+         * true if action may be passed to takeActions: one of the 6 directions
+         * in a discrete game, a finite angle otherwise. Checked by the callers
+         * which get actions from outside, takeActions trusts them.
+         */
+        template<typename T>
+        static bool isValidAction(T action, bool discrete)
+        {
+            if (discrete) return action >= 0 && action < 6;
+            return std::isfinite((double) action);
+        }
         void resetPlayer(int playerId);
+
+        /**
+         * clears the board and respawns every player in order, so the
+         * new episode only depends on the state of the random numbers
+         */
+        void resetAll();
+
+        /**
+         * 6 bit masks over the discrete actions, bit i for DIRECTIONS[i].
+         * safe holds the directions in which the player survives the next
+         * step whatever the others do, i.e. all but those onto the border.
+         * Own claims do not kill in this game, so re-entering the own trail is safe.
+         * danger holds the directions in which the player may die, depending on
+         * the moves of the others: another head can reach the target tile (head
+         * on, or both heads swap) and the player does not own it. If another head
+         * can reach the trail of the player, every direction is dangerous.
+         * Losing the whole territory to the loop of another player does not
+         * depend on the direction and is not foreseen.
+         */
+        void getActionMasks(Player &player, int &safe, int &danger);
+
+        /**
+         * appends the whole state of the game to writer: the random numbers,
+         * the board and all players. Only plain values and arrays are
+         * written, a snapshot is restored with a few memcpy.
+         */
+        void snapshot(SnapshotWriter &writer);
+
+        /**
+         * restores a snapshot of a game with the same number of players, map
+         * radius and movement. Returns false if it does not match, the state of the
+         * game is undefined then, unless reader is a dry run which changes nothing.
+         * A dry run also checks that every owner and tile of the snapshot is in range.
+         * See Controller::restore, which checks the whole snapshot first.
+         */
+        bool restore(SnapshotReader &reader);
 };
 
 
@@ -0,0 +1,160 @@
+#ifndef HEXAR_MCTS_H
+#define HEXAR_MCTS_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include "controller.h"
+#include "bots.h"
+#include "random.h"
+#include "thread_pool.h"
+
+
+/**
+ * tree parallel Monte Carlo tree search over the discrete actions of one player.
+ * Every worker thread owns a clone of the controller: a simulation restores the
+ * snapshot of the root into it and replays the actions along its path, so the
+ * nodes hold no game states. The other players are stepped by the bots of the
+ * controller, agents without a bot by the rollout bot.
+ * The workers share one tree. A running simulation adds a virtual loss to the
+ * nodes of its path, which steers the other workers to different paths.
+ * A new leaf is valued by a rollout of rolloutDepth steps with the rollout bot,
+ * plus the discounted value of the state where the rollout ended if an
+ * evaluator is given. The evaluator values batchSize leaves at once, e.g. with
+ * a value network, their simulations wait for it with the virtual loss applied.
+ */
+class Mcts
+{
+public:
+    /**
+     * writes the value of each of the count observations (observationSize
+     * floats each) to values, returns false to cancel the search.
+     * Called on the thread which runs search.
+     */
+    typedef std::function<bool(const float *observations, int count, float *values)> Evaluator;
+
+private:
+    // a node is the state after the action which leads to it
+    struct Node {
+        std::atomic<int> visits;
+        std::atomic<float> valueSum;
+        std::atomic<int> state;
+        Node *children;
+    };
+
+    enum {
+        NODE_LEAF,
+        NODE_EXPANDING,
+        NODE_EXPANDED
+    };
+
+    // the path of a simulation and the return of its rollout
+    struct Simulation {
+        std::vector<Node *> path;
+        std::vector<float> rewards;
+        float leafReturn;
+        float valueScale;
+        bool needsValue;
+    };
+
+    struct Worker {
+        Controller *controller;
+        std::vector<Bot *> bots;
+        Rng rng;
+
+        // blocks of 6 children, reused by the following searches
+        std::vector<std::unique_ptr<Node[]>> blocks;
+        size_t numUsedBlocks;
+
+        std::vector<int> actions;
+        std::vector<float> rewards;
+        std::unique_ptr<bool[]> dones;
+
+        // used without an evaluator, the simulations are backed up right away
+        Simulation simulation;
+    };
+
+    const int numPlayers;
+    const long int observationSize;
+    const int rolloutDepth;
+    const float discount;
+    const float exploration;
+    const float virtualLoss;
+    const int batchSize;
+
+    std::vector<Worker> workers;
+    ThreadPool pool;
+
+    Node root;
+    const char *rootState;
+    size_t rootStateSize;
+    int playerId;
+    std::atomic<bool> failed;
+
+    // the simulations of a batch, waiting for the evaluator
+    std::vector<Simulation> simulations;
+    std::vector<float> leafObservations;
+    std::vector<float> leafValues;
+
+    std::mutex callMutex;
+
+    static void resetNode(Node &node);
+    static void addValue(std::atomic<float> &sum, float value);
+
+    Node *expand(Worker &worker);
+    int select(Worker &worker, Node &node);
+
+    /**
+     * steps the game of the worker, the player takes action or follows
+     * the rollout bot for action -1. Returns true if the player is done.
+     */
+    bool step(Worker &worker, int action, float &reward);
+
+    /**
+     * selects a path from the root, expands its leaf and runs the rollout.
+     * If observation is given and the player is not done, the leaf still
+     * needs a value of the evaluator and its observation is written there.
+     */
+    void simulate(Worker &worker, Simulation &simulation, float *observation);
+    void backup(Simulation &simulation, float leafValue);
+
+public:
+    /**
+     * searches on copies of controller, which must have a discrete action space.
+     * rolloutBot is one of the BOT_* types, its rollouts take at most rolloutDepth steps.
+     */
+    Mcts(Controller &controller,
+         int numThreads = 1,
+         int rolloutBot = BOT_RANDOM,
+         int rolloutDepth = 20,
+         float discount = 0.99,
+         float exploration = 1.4,
+         float virtualLoss = 1.0,
+         int batchSize = 16,
+         uint64_t seed = 0);
+
+    ~Mcts();
+
+    long int getObservationSize();
+
+    /**
+     * runs numSimulations simulations from the state in the snapshot of the
+     * controller (see Controller::snapshot) for playerId and writes the
+     * visits and the mean return of each of the 6 actions of the root to
+     * visits and values. Without an evaluator, the leaves are only valued by
+     * their rollouts. Returns false if the snapshot does not match or the
+     * evaluator cancelled the search.
+     */
+    bool search(const char *state, size_t stateSize, int playerId, int numSimulations,
+                const Evaluator &evaluator, int *visits, float *values);
+
+    /**
+     * a search must only run on one thread at a time, see Controller::getMutex
+     */
+    std::mutex &getMutex();
+};
+
+
+#endif //HEXAR_MCTS_H
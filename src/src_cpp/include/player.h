@@ -4,6 +4,7 @@
 #include <vector>
 #include <unordered_set>
 #include "definitions.h"
+#include "snapshot.h"
 
 /**
  * Player class represents an agent
@@ -36,10 +37,18 @@ private:
 
     CartCoord position;
 
+    // the player stands on the center of head and position is not kept, see setHead
+    bool onTile;
+
+    // the same position in fixed point, see Game::takeActions
+    FixedCoord fixedPosition;
+    int32_t fixedVelocity;
+
     Tile head;
-    // history of claimed but not yet captured tiles
+    // history of claimed but not yet captured tiles,
+    // in the order they were claimed
     //std::unordered_set<Tile> tail;
-    std::unordered_set<Tile> claimedArea;
+    std::vector<Tile> claimedArea;
 
     // keep track of the players territory bounding box
     // while the player wanders around
@@ -60,10 +69,16 @@ public:
     int getNumClaims();
     float getVelocity();
     Tile getHead();
+    /**
+     * the position in unit coordinates. After setHead it is derived from the head,
+     * only the renderers and the continuous movement need it.
+     */
     CartCoord getPosition();
+    FixedCoord getFixedPosition();
+    int32_t getFixedVelocity();
     TileBoundingBox getBoundingBox();
     std::vector<CartCoord> &getPath();
-    std::unordered_set<Tile> &getClaim();
+    std::vector<Tile> &getClaim();
 
     // setter
     void setDead(bool dead);
@@ -72,6 +87,16 @@ public:
     void setCaptures(int captures);
     void addCaptures(int captures);
     void setPosition(CartCoord pos);
+
+    /**
+     * moves the player onto the center of a tile, used by the discrete movement
+     */
+    void setHead(Tile t);
+
+    /**
+     * sets the position in fixed point, the head is found with integer math
+     */
+    void setFixedPosition(FixedCoord pos);
     void setVelocity(float v);
     
     // other
@@ -82,6 +107,13 @@ public:
     
     //void reset();
     void spawn(Tile spawnPoint);
+
+    /**
+     * writes / reads the whole state of the player, see Game::snapshot.
+     * A dry run fails for tiles and positions off the board of mapRadius.
+     */
+    void snapshot(SnapshotWriter &writer);
+    void restore(SnapshotReader &reader, int mapRadius);
    
     bool operator==(Player &other);
     bool operator!=(Player &other);
@@ -7,13 +7,13 @@ extern "C" {
 
 void destroy_interface(PyObject *interface);
 
-static PyObject* setup(PyObject *self, PyObject *args);
+static PyObject* setup(PyObject *self, PyObject *args, PyObject *kwargs);
 
 static PyObject* reset_player(PyObject *self, PyObject *args);
 
 static PyObject* take_actions(PyObject *self, PyObject *args);
 
-static PyObject* get_observation(PyObject *self, PyObject *args);
+static PyObject* get_observation(PyObject *self, PyObject *args, PyObject *kwargs);
 
 static PyObject* is_dead(PyObject *self, PyObject *args);
 
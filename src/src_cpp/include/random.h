@@ -0,0 +1,67 @@
+#ifndef HEXAR_RANDOM_H
+#define HEXAR_RANDOM_H
+
+#include <cstdint>
+
+
+/**
+ * xoshiro256** pseudo random number generator, see https://prng.di.unimi.it.
+ * Every game owns one, so games do not share any random state and
+ * are reproducible from their seed, also when they run on different threads.
+ */
+class Rng
+{
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    explicit Rng(uint64_t seed = 0)
+    {
+        this->seed(seed);
+    }
+
+    /**
+     * expands seed to the whole state with splitmix64,
+     * so similar seeds give unrelated sequences
+     */
+    void seed(uint64_t seed)
+    {
+        for (auto &s : state) {
+            uint64_t z = (seed += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            s = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next()
+    {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+
+        return result;
+    }
+
+    /**
+     * uniform integer in [0, n), for n > 0
+     */
+    int nextInt(int n)
+    {
+        return (int) (((next() >> 32) * (uint64_t) n) >> 32);
+    }
+};
+
+
+#endif //HEXAR_RANDOM_H
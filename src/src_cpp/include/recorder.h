@@ -0,0 +1,68 @@
+#ifndef HEXAR_RECORDER_H
+#define HEXAR_RECORDER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <fstream>
+#include <condition_variable>
+#include "game.h"
+#include "renderer.h"
+
+
+/**
+ * records the demo view of a game without a window.
+ * capture() renders the current frame on the calling thread and hands
+ * it to a background thread, which writes it to disk either as one
+ * uncompressed y4m video (path is the file name) or as a sequence of 
+ * ppm images (path is the prefix of the file names).
+ * The queue between the two is bounded; if the writer falls behind,
+ * new frames are dropped instead of blocking the simulation.
+ */
+class Recorder
+{
+private:
+    const std::string path;
+    const int format;
+    const int width;
+    const int height;
+    const unsigned long maxQueueSize;
+
+    RecordingRenderer renderer;
+    std::ofstream video;
+
+    std::deque<std::vector<Uint8>> queue;
+    std::vector<std::vector<Uint8>> unusedFrames;
+    std::mutex queueMutex;
+    std::condition_variable frameAvailable;
+    std::thread writer;
+    bool stopping;
+
+    long numWritten;
+    long numDropped;
+    bool failed;
+
+    void writerLoop();
+    void writeFrame(const std::vector<Uint8> &frame, std::vector<Uint8> &planes);
+
+public:
+    Recorder(Game &game, const std::string &path, int format, int width, int height,
+             int queueSize = RECORDING_DEFAULT_QUEUE_SIZE);
+
+    ~Recorder();
+
+    /**
+     * writes all queued frames and closes the output
+     */
+    void close();
+
+    bool isOpen();
+    void capture();
+    long getNumWritten();
+    long getNumDropped();
+};
+
+
+#endif //HEXAR_RECORDER_H
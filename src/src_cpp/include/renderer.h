@@ -27,12 +27,21 @@ protected:
 
     TileBoundingBox getViewportBoundingBox();
 
+    // scratch buffer of the polygon filler. SDL2_gfx keeps a global one in
+    // filledPolygonRGBA, so every renderer brings its own to be usable from
+    // several threads at once.
+    int *polyInts;
+    int polyAllocated;
+    void fillPolygon(const Sint16 *vx, const Sint16 *vy, int n, SDL_Color color);
+    void drawThickLine(ScreenCoord c1, ScreenCoord c2, Uint8 lineWidth, SDL_Color color);
+
     void drawLines(std::vector<CartCoord> points, float width, SDL_Color color);
     void drawCircle(CartCoord center, float radius, SDL_Color color);
     void drawHexagon(CartCoord center, float radius, SDL_Color color);
     void drawTile(Tile tile, SDL_Color color);
 
     void render();
+    void renderDemoScene();
 
 public:
     Renderer(Game &game, int width, int height);
@@ -70,20 +79,61 @@ public:
 
 /**
  * - focus is always on a specific player
+ * - with supersampling > 1 the scene is rendered at supersampling times
+ *   the output resolution and reduced by area averaging in writeTo()
  */
 class ObservationRenderer : public Renderer
 {
 private:
-    Uint32 getPixel(int x, int y);
-    
+    const int supersampling;
+    const int outWidth;
+    const int outHeight;
+
+    // per output column accumulator for the area averaging
+    std::vector<Uint32> rowSums;
 
 public:
-    ObservationRenderer(Game &game, int width, int height);
+    ObservationRenderer(Game &game, int width, int height, int supersampling = 1);
     ~ObservationRenderer();
+    void setScale(float s);
     void renderForPlayer(Player &player);
     void writeTo(float *obsMemAddr, unsigned long size);
     //void getPixel(int x, int y, uint8_t *r, uint8_t *g, uint8_t *b);
     void showOnly(CartCoord pos, int hexRadius);
+
+    /**
+     * renders the scene for no player in particular. Every pixel stores
+     * what is drawn there (red channel) and to which player it belongs 
+     * (green channel), so the same frame can be coloured for any player.
+     */
+    void renderSemantic();
+
+    /**
+     * colours the semantic frame of the given renderer for the player,
+     * hides everything outside of hexRadius around pos (like showOnly)
+     * and writes the result to obsMemAddr like writeTo.
+     * Both renderers must have the same size, scale and focus.
+     */
+    void writeFromSemantic(ObservationRenderer &semantic, Player &player, CartCoord pos, int hexRadius,
+                           float *obsMemAddr, unsigned long size);
+};
+
+
+/**
+ * renders the demo view offscreen, showing the whole arena.
+ * Used to record videos without a window.
+ */
+class RecordingRenderer : public Renderer
+{
+public:
+    RecordingRenderer(Game &game, int width, int height);
+    ~RecordingRenderer();
+    void render();
+
+    /**
+     * copies the last frame to dst as width x height rgb bytes
+     */
+    void copyPixels(Uint8 *dst);
 };
 
 
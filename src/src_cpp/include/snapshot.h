@@ -0,0 +1,215 @@
+#ifndef HEXAR_SNAPSHOT_H
+#define HEXAR_SNAPSHOT_H
+
+#include <vector>
+#include <cstring>
+#include <type_traits>
+
+
+/**
+ * appends plain values and arrays to a byte buffer, see Game::snapshot.
+ * Everything is copied with memcpy, so only trivially copyable types are allowed.
+ */
+class SnapshotWriter
+{
+private:
+    std::vector<char> &buffer;
+
+public:
+    explicit SnapshotWriter(std::vector<char> &buffer) : buffer(buffer)
+    {
+    }
+
+    template<typename T>
+    void write(const T &value)
+    {
+        writeArray(&value, 1);
+    }
+
+    template<typename T>
+    void writeArray(const T *values, size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots hold trivially copyable types only");
+
+        size_t size = buffer.size();
+        buffer.resize(size + count * sizeof(T));
+        if (count > 0) memcpy(buffer.data() + size, values, count * sizeof(T));
+    }
+
+    /**
+     * the size followed by the elements
+     */
+    template<typename T>
+    void writeVector(const std::vector<T> &values)
+    {
+        write<long>(values.size());
+        writeArray(values.data(), values.size());
+    }
+};
+
+/**
+ * reads what SnapshotWriter wrote, in the same order. Reading past the end
+ * fails the reader instead of touching other memory, the values are unchanged then.
+ * A dry run only checks the snapshot and leaves all values unchanged, so a
+ * snapshot can be validated completely before anything is restored:
+ * the sizes, bools which are neither 0 nor 1 and every value for which
+ * the isValid function of the read fails.
+ */
+class SnapshotReader
+{
+private:
+    const char *data;
+    const char *end;
+    const bool dryRun;
+    bool failed;
+
+    // reads a value the reader itself needs, also in a dry run
+    template<typename T>
+    bool readHeader(T &value)
+    {
+        if (failed || (size_t) (end - data) < sizeof(T)) {
+            failed = true;
+            return false;
+        }
+
+        memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return true;
+    }
+
+public:
+    SnapshotReader(const char *data, size_t size, bool dryRun = false) :
+        data(data), end(data + size), dryRun(dryRun), failed(false)
+    {
+    }
+
+    template<typename T>
+    void read(T &value)
+    {
+        readArray(&value, 1);
+    }
+
+    /**
+     * in a dry run, the value has to pass isValid(value)
+     */
+    template<typename T, typename Check>
+    void read(T &value, Check isValid)
+    {
+        readArray(&value, 1, [&](const T &v, size_t) { return isValid(v); });
+    }
+
+    template<typename T>
+    void readArray(T *values, size_t count)
+    {
+        readArray(values, count, [](const T &, size_t) { return true; });
+    }
+
+    /**
+     * in a dry run, every element has to pass isValid(value, index).
+     * The elements are checked in order, so isValid may collect them.
+     */
+    template<typename T, typename Check>
+    void readArray(T *values, size_t count, Check isValid)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots hold trivially copyable types only");
+
+        if (failed || (size_t) (end - data) < count * sizeof(T)) {
+            failed = true;
+            return;
+        }
+
+        if (dryRun) {
+            for (size_t i = 0; i < count; i++) {
+                const char *bytes = data + i * sizeof(T);
+
+                if (std::is_same<T, bool>::value && (unsigned char) *bytes > 1) {
+                    failed = true;
+                    return;
+                }
+
+                T value;
+                memcpy(&value, bytes, sizeof(T));
+
+                if (!isValid(value, i)) {
+                    failed = true;
+                    return;
+                }
+            }
+        } else if (count > 0) {
+            memcpy(values, data, count * sizeof(T));
+        }
+
+        data += count * sizeof(T);
+    }
+
+    /**
+     * reads a value and fails the reader unless it equals expected, e.g. for a header
+     */
+    template<typename T>
+    bool expect(const T &expected)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots hold trivially copyable types only");
+
+        T value;
+
+        if (!readHeader(value) || memcmp(&value, &expected, sizeof(T)) != 0) {
+            failed = true;
+        }
+
+        return !failed;
+    }
+
+    /**
+     * with expectedSize >= 0, a vector of another size fails the reader
+     */
+    template<typename T>
+    void readVector(std::vector<T> &values, long expectedSize = -1)
+    {
+        readVector(values, expectedSize, [](const T &, size_t) { return true; });
+    }
+
+    /**
+     * in a dry run, every element has to pass isValid(value, index), see readArray
+     */
+    template<typename T, typename Check>
+    void readVector(std::vector<T> &values, long expectedSize, Check isValid)
+    {
+        long size = -1;
+        readHeader(size);
+
+        if (failed || size < 0 || (expectedSize >= 0 && size != expectedSize)
+            || (size_t) size > (size_t) (end - data) / sizeof(T)) {
+            failed = true;
+            return;
+        }
+
+        if (!dryRun) values.resize(size);
+        readArray(values.data(), size, isValid);
+    }
+
+    /**
+     * fails the reader, for checks which need more than one value
+     */
+    void fail()
+    {
+        failed = true;
+    }
+
+    bool isDryRun()
+    {
+        return dryRun;
+    }
+
+    bool hasFailed()
+    {
+        return failed;
+    }
+
+    bool isComplete()
+    {
+        return !failed && data == end;
+    }
+};
+
+
+#endif //HEXAR_SNAPSHOT_H
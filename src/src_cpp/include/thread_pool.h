@@ -0,0 +1,69 @@
+#ifndef HEXAR_THREADPOOL_H
+#define HEXAR_THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+
+/**
+ * small work-stealing pool of persistent worker threads.
+ * parallelFor() splits the task indices into one contiguous block per
+ * worker, the calling thread takes part as worker 0. A worker runs its
+ * own block from the front and, once it is empty, steals from the back
+ * of the other blocks, so uneven tasks (e.g. games with and without
+ * pixel observations) still keep all threads busy.
+ * Every task gets the id of the worker which runs it, so callers can
+ * keep one set of scratch objects per worker.
+ */
+class ThreadPool
+{
+private:
+    // padded, so the queues of different workers never share a cache line
+    struct alignas(64) WorkQueue {
+        std::mutex lock;
+        std::deque<int> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<WorkQueue> queues;
+    const bool pinThreads;
+
+    std::mutex poolMutex;
+    std::condition_variable wakeUp;
+    std::condition_variable finished;
+
+    const std::function<void(int, int)> *task;
+    int numBusy;
+    unsigned long generation;
+    bool stopping;
+
+    void workerLoop(int workerId);
+    void runTasks(int workerId);
+    bool popTask(int workerId, int &index);
+    bool stealTask(int workerId, int &index);
+    void pinToCore(int workerId);
+
+public:
+    /**
+     * with pinThreads, worker i is bound to core i (modulo the number
+     * of cores). The calling thread, worker 0, is never pinned.
+     */
+    explicit ThreadPool(int numThreads, bool pinThreads = false);
+    ~ThreadPool();
+
+    int getNumThreads();
+
+    /**
+     * calls fn(index, workerId) for every index in [0, n).
+     * This is a join barrier: it blocks until all calls have returned,
+     * so their results are complete and visible to the caller.
+     */
+    void parallelFor(int n, const std::function<void(int index, int workerId)> &fn);
+};
+
+
+#endif //HEXAR_THREADPOOL_H
@@ -22,6 +22,16 @@ HexCoord cartToHex(CartCoord c);
 
 Tile cartToTile(CartCoord c);
 
+FixedCoord cartToFixed(CartCoord c);
+
+CartCoord fixedToCart(FixedCoord c);
+
+/**
+ * the tile of a fixed point position like cartToTile,
+ * but with integer math only
+ */
+Tile fixedToTile(FixedCoord c);
+
 CartCoord hexToCart(HexCoord c);
 
 HexCoord cubeToHex(CubeCoord c);
@@ -48,8 +58,10 @@ void getNeighbors(Tile t, Tile *dst);
 
 bool doIntersect(TileBoundingBox a, TileBoundingBox b);
 
+#ifndef HEXARIO_HEADLESS
 SDL_Color lighten(SDL_Color color, float percentage=0.1);
 
 SDL_Color darken(SDL_Color color, float percentage=0.1);
+#endif //HEXARIO_HEADLESS
 
 #endif //HEXAR_UTILS_H
@@ -0,0 +1,142 @@
+#ifndef HEXAR_VECTORCONTROLLER_H
+#define HEXAR_VECTORCONTROLLER_H
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include "controller.h"
+#include "thread_pool.h"
+
+
+/**
+ * an event of the game env, see VectorController::getEvents
+ */
+typedef struct {
+    int32_t env;
+    GameEvent event;
+} VectorEvent;
+
+/**
+ * drives numEnvs independent games with numAgents agents each, so a
+ * whole batch of environments is stepped by one call.
+ * Rewards and dones are computed by the controllers, which run with
+ * autoReset: agents which are done are respawned immediately and their
+ * observation is the first one of the new episode.
+ * All arrays are stored env-major: index = env * numAgents + agent.
+ * The games are spread over a work-stealing thread pool, every game
+ * is stepped and observed by a single worker. Pixel observations are
+ * rendered in parallel as well, the renderers of different games share
+ * no polygon buffer (see Renderer::polyInts).
+ * stepAsync runs a step on a background thread, so the caller can
+ * prepare the next actions (e.g. of another batch) in the meantime.
+ */
+class VectorController {
+private:
+    const int numEnvs;
+    const int numAgents;
+    const long int observationSize;
+
+    std::vector<Controller *> envs;
+    ThreadPool pool;
+
+    std::mutex callMutex;
+
+    // the background step, see stepAsync
+    std::thread stepper;
+    std::mutex asyncMutex;
+    std::condition_variable asyncChanged;
+    std::function<void()> asyncStep;
+    bool stopping;
+
+    void stepperLoop();
+
+
+public:
+    VectorController(int numEnvs,
+                     int numAgents,
+                     int mapRadius,
+                     bool localPerspective,
+                     bool featureObservations,
+                     bool discreteActionSpace,
+                     int observationRadius,
+                     int pxObservationWidth,
+                     int pxObservationHeight,
+                     float defaultVelocity,
+                     int pxSupersampling,
+                     bool sharedGlobalRender,
+                     RewardWeights rewardWeights,
+                     int maxSteps,
+                     int numThreads = 1,
+                     bool pinThreads = false,
+                     uint64_t seed = 0,
+                     int numHeadings = 0);
+
+    ~VectorController();
+
+    int getNumEnvs();
+    int getNumAgents();
+    long int getObservationSize();
+    bool isActionSpaceDiscrete();
+
+    /**
+     * respawns all agents of all games
+     */
+    void reset();
+
+    /**
+     * seeds the game of environment i with seed + i, see Game::seed
+     */
+    void seed(uint64_t seed);
+
+    /**
+     * actions has numEnvs * numAgents entries, observations 
+     * numEnvs * numAgents * observationSize. info receives one record 
+     * per agent with the fields selected by infoFields (see 
+     * Controller::getInfo), they hold the values from before a done 
+     * agent was respawned.
+     * The actions are read in place, T is one of FOR_EACH_ACTION_TYPE.
+     */
+    template<typename T>
+    void step(const T *actions, float *observations, float *rewards, bool *dones,
+              int infoFields, char *info);
+
+    /**
+     * starts step on the background thread and returns immediately.
+     * The arrays must stay valid and untouched until stepWait returned,
+     * there can only be one pending step.
+     * The step locks the mutex itself, so it is serialized with the other
+     * calls; stepAsync and stepWait must be called without holding it.
+     */
+    template<typename T>
+    void stepAsync(const T *actions, float *observations, float *rewards, bool *dones,
+                   int infoFields, char *info);
+
+    /**
+     * blocks until the step started by stepAsync is complete
+     */
+    void stepWait();
+
+    void getObservations(float *observations);
+
+    /**
+     * the action masks of all agents, see Controller::getActionMasks
+     */
+    void getActionMasks(unsigned char *safe, unsigned char *danger);
+
+    /**
+     * the events of all games since their last step, see Game::getEvents.
+     * getEvents writes the getNumEvents events in the order of the games.
+     */
+    long int getNumEvents();
+    void getEvents(VectorEvent *events);
+
+    /**
+     * same contract as Controller::getMutex
+     */
+    std::mutex &getMutex();
+};
+
+
+#endif //HEXAR_VECTORCONTROLLER_H
@@ -0,0 +1,318 @@
+#include <cmath>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include "include/mcts.h"
+
+using namespace std;
+
+
+Mcts::Mcts(Controller &controller,
+           int numThreads,
+           int rolloutBot,
+           int rolloutDepth,
+           float discount,
+           float exploration,
+           float virtualLoss,
+           int batchSize,
+           uint64_t seed) :
+    numPlayers(controller.getNumPlayers()),
+    observationSize(controller.getObservationSize()),
+    rolloutDepth(max(rolloutDepth, 0)),
+    discount(discount),
+    exploration(exploration),
+    virtualLoss(virtualLoss),
+    batchSize(max(batchSize, 1)),
+    workers(max(numThreads, 1)),
+    pool(max(numThreads, 1)),
+    rootState(nullptr),
+    rootStateSize(0),
+    playerId(0),
+    failed(false),
+    simulations(this->batchSize),
+    leafValues(this->batchSize)
+{
+    for (int i = 0; i < (int) workers.size(); i++) {
+        Worker &worker = workers[i];
+        worker.controller = controller.clone();
+        worker.rng.seed(seed + i);
+        worker.numUsedBlocks = 0;
+        worker.actions.resize(numPlayers, 0);
+        worker.rewards.resize(numPlayers, 0);
+        worker.dones.reset(new bool[numPlayers]);
+
+        // the bots of the controller step their players themselves
+        for (int j = 0; j < numPlayers; j++) {
+            Bot *bot = nullptr;
+
+            if (!controller.isBot(j)) {
+                bot = Bot::create(rolloutBot);
+                if (bot == nullptr) bot = new RandomBot();
+            }
+
+            worker.bots.push_back(bot);
+        }
+    }
+
+    resetNode(root);
+}
+
+Mcts::~Mcts()
+{
+    for (auto &worker : workers) {
+        delete worker.controller;
+
+        for (auto *bot : worker.bots) {
+            delete bot;
+        }
+    }
+}
+
+long int Mcts::getObservationSize()
+{
+    return observationSize;
+}
+
+std::mutex &Mcts::getMutex()
+{
+    return callMutex;
+}
+
+void Mcts::resetNode(Node &node)
+{
+    node.visits = 0;
+    node.valueSum = 0;
+    node.state = NODE_LEAF;
+    node.children = nullptr;
+}
+
+void Mcts::addValue(atomic<float> &sum, float value)
+{
+    float current = sum.load();
+    while (!sum.compare_exchange_weak(current, current + value)) {}
+}
+
+Mcts::Node *Mcts::expand(Worker &worker)
+{
+    if (worker.numUsedBlocks == worker.blocks.size()) {
+        worker.blocks.emplace_back(new Node[6]);
+    }
+
+    Node *children = worker.blocks[worker.numUsedBlocks++].get();
+
+    for (int i = 0; i < 6; i++) {
+        resetNode(children[i]);
+    }
+
+    return children;
+}
+
+int Mcts::select(Worker &worker, Node &node)
+{
+    float logVisits = log((float) max(node.visits.load(), 1));
+
+    // ties and unvisited children are taken in a random order
+    int offset = worker.rng.nextInt(6);
+    int best = offset;
+    float bestScore = -numeric_limits<float>::infinity();
+
+    for (int i = 0; i < 6; i++) {
+        int action = (offset + i) % 6;
+        Node &child = node.children[action];
+        int visits = child.visits.load();
+
+        if (visits == 0) {
+            return action;
+        }
+
+        float score = child.valueSum.load() / visits + exploration * sqrt(logVisits / visits);
+
+        if (score > bestScore) {
+            best = action;
+            bestScore = score;
+        }
+    }
+
+    return best;
+}
+
+bool Mcts::step(Worker &worker, int action, float &reward)
+{
+    Game &game = worker.controller->getGame();
+
+    for (int i = 0; i < numPlayers; i++) {
+        Player &player = game.getPlayer(i);
+
+        if (i == playerId && action >= 0) {
+            worker.actions[i] = action;
+        } else if (worker.bots[i] != nullptr && !player.isDead()) {
+            worker.actions[i] = worker.bots[i]->act(game, player);
+        }
+    }
+
+    worker.controller->takeActions(worker.actions.data(), worker.rewards.data(), worker.dones.get());
+    reward = worker.rewards[playerId];
+
+    return worker.dones[playerId];
+}
+
+void Mcts::simulate(Worker &worker, Simulation &simulation, float *observation)
+{
+    simulation.path.clear();
+    simulation.rewards.clear();
+    simulation.leafReturn = 0;
+    simulation.valueScale = 0;
+    simulation.needsValue = false;
+
+    // checked once by search
+    worker.controller->restoreTrusted(rootState, rootStateSize);
+
+    // the plans of the bots are not part of the tree, every path starts without one
+    for (auto *bot : worker.bots) {
+        if (bot != nullptr) bot->reset();
+    }
+
+    Node *node = &root;
+    root.visits++;
+    bool done = false;
+
+    while (!done) {
+        int state = NODE_LEAF;
+
+        if (node->state.compare_exchange_strong(state, NODE_EXPANDING)) {
+            node->children = expand(worker);
+            node->state = NODE_EXPANDED;
+            break;
+        }
+
+        if (state != NODE_EXPANDED) {
+            // another worker is expanding it, valued as a leaf once more
+            break;
+        }
+
+        int action = select(worker, *node);
+        node = &node->children[action];
+        node->visits++;
+        addValue(node->valueSum, -virtualLoss);
+
+        float reward;
+        done = step(worker, action, reward);
+        simulation.path.push_back(node);
+        simulation.rewards.push_back(reward);
+    }
+
+    float scale = 1;
+
+    for (int i = 0; i < rolloutDepth && !done; i++) {
+        float reward;
+        done = step(worker, -1, reward);
+        simulation.leafReturn += scale * reward;
+        scale *= discount;
+    }
+
+    simulation.valueScale = scale;
+    simulation.needsValue = observation != nullptr && !done;
+
+    if (simulation.needsValue) {
+        worker.controller->getObservation(playerId, observation, observationSize);
+    }
+}
+
+void Mcts::backup(Simulation &simulation, float leafValue)
+{
+    float value = simulation.leafReturn + simulation.valueScale * leafValue;
+
+    for (int i = (int) simulation.path.size() - 1; i >= 0; i--) {
+        value = simulation.rewards[i] + discount * value;
+
+        // the visit was counted on the way down, together with the virtual loss
+        addValue(simulation.path[i]->valueSum, value + virtualLoss);
+    }
+}
+
+bool Mcts::search(const char *state, size_t stateSize, int playerId, int numSimulations,
+                  const Evaluator &evaluator, int *visits, float *values)
+{
+    fill(visits, visits + 6, 0);
+    fill(values, values + 6, 0.f);
+
+    Controller &first = *workers[0].controller;
+
+    if (playerId < 0 || playerId >= numPlayers || first.isBot(playerId)) {
+        cerr << "error: cannot search for player " << playerId << ", it is no agent" << endl;
+        return false;
+    }
+
+    if (!first.restore(state, stateSize)) {
+        return false;
+    }
+
+    if (first.getGame().getPlayer(playerId).isDead()) {
+        return true;
+    }
+
+    rootState = state;
+    rootStateSize = stateSize;
+    this->playerId = playerId;
+    failed = false;
+
+    resetNode(root);
+    for (auto &worker : workers) {
+        worker.numUsedBlocks = 0;
+    }
+
+    if (!evaluator) {
+        pool.parallelFor(numSimulations, [&](int index, int workerId) {
+            Worker &worker = workers[workerId];
+            simulate(worker, worker.simulation, nullptr);
+
+            if (!failed) {
+                backup(worker.simulation, 0);
+            }
+        });
+    } else {
+        leafObservations.resize(batchSize * observationSize);
+
+        for (int start = 0; start < numSimulations && !failed; start += batchSize) {
+            int count = min(batchSize, numSimulations - start);
+
+            pool.parallelFor(count, [&](int index, int workerId) {
+                simulate(workers[workerId], simulations[index], &leafObservations[index * observationSize]);
+            });
+
+            if (failed) break;
+
+            // only the leaves where the player is not done are evaluated
+            int numLeaves = 0;
+
+            for (int i = 0; i < count; i++) {
+                if (!simulations[i].needsValue) continue;
+
+                if (numLeaves != i) {
+                    copy_n(&leafObservations[i * observationSize], observationSize,
+                           &leafObservations[numLeaves * observationSize]);
+                }
+                numLeaves++;
+            }
+
+            if (numLeaves > 0 && !evaluator(leafObservations.data(), numLeaves, leafValues.data())) {
+                failed = true;
+                break;
+            }
+
+            for (int i = 0, leaf = 0; i < count; i++) {
+                backup(simulations[i], simulations[i].needsValue ? leafValues[leaf++] : 0);
+            }
+        }
+    }
+
+    if (root.state == NODE_EXPANDED) {
+        for (int i = 0; i < 6; i++) {
+            Node &child = root.children[i];
+            visits[i] = child.visits;
+            values[i] = child.visits > 0 ? child.valueSum / child.visits : 0;
+        }
+    }
+
+    return !failed;
+}
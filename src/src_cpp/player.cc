@@ -10,6 +10,9 @@ using namespace std;
 Player::Player(int id, float velocity) : 
     id(id), position(CartCoord{0, 0}), velocity(velocity)
 {
+    fixedPosition = FixedCoord{0, 0};
+    onTile = false;
+    fixedVelocity = (int32_t) lround(velocity * FIXED_ONE);
     dead = true;
     winner = false;
     kills = 0;
@@ -68,6 +71,11 @@ float Player::getVelocity()
     return velocity;
 }
 
+int32_t Player::getFixedVelocity()
+{
+    return fixedVelocity;
+}
+
 Tile Player::getHead()
 {
     return head;
@@ -75,10 +83,15 @@ Tile Player::getHead()
 
 CartCoord Player::getPosition()
 {
-    return position;
+    return onTile ? hexToCart(tileToHex(head)) : position;
+}
+
+FixedCoord Player::getFixedPosition()
+{
+    return fixedPosition;
 }
 
-std::unordered_set<Tile> &Player::getClaim()
+std::vector<Tile> &Player::getClaim()
 {
     return claimedArea;
 }
@@ -120,23 +133,43 @@ void Player::addCaptures(int c)
 
 void Player::setPosition(CartCoord pos)
 {
+    onTile = false;
     position = pos;
+    fixedPosition = cartToFixed(pos);
     head = hexToTile(cartToHex(pos));
 }
 
+void Player::setFixedPosition(FixedCoord pos)
+{
+    onTile = false;
+    fixedPosition = pos;
+    position = fixedToCart(pos);
+    head = fixedToTile(pos);
+}
+
+void Player::setHead(Tile t)
+{
+    onTile = true;
+    head = t;
+}
+
 void Player::setVelocity(float v)
 {
     velocity = v;
+    fixedVelocity = (int32_t) lround(v * FIXED_ONE);
 }
 
 void Player::claim(Tile t)
 {
-    if (path.empty() || distance(position, path.back()) > 1) {
-        path.push_back(position);
+    // the path is drawn by the renderers, so it is the one place which needs positions on tiles
+    CartCoord pos = getPosition();
+
+    if (path.empty() || distance(pos, path.back()) > 1) {
+        path.push_back(pos);
     }
 
     if (!hasClaimed(t)) {
-        claimedArea.insert(t);
+        claimedArea.push_back(t);
         boundingBox.min.q = min(boundingBox.min.q, head.q);
         boundingBox.max.q = max(boundingBox.max.q, head.q);
         boundingBox.min.r = min(boundingBox.min.r, head.r);
@@ -185,11 +218,67 @@ void Player::spawn(Tile spawnPoint)
     claimedArea.clear();
 
     // reset position
+    onTile = false;
     head = spawnPoint;
     position = hexToCart(tileToHex(spawnPoint));
+    fixedPosition = cartToFixed(position);
 
     boundingBox = TileBoundingBox{
         Tile{spawnPoint.q - 1, spawnPoint.r - 1},
         Tile{spawnPoint.q + 1, spawnPoint.r + 1}
     };
 }
+
+void Player::snapshot(SnapshotWriter &writer)
+{
+    writer.write(dead);
+    writer.write(winner);
+    writer.write(kills);
+    writer.write(captures);
+    writer.write(velocity);
+    writer.write(fixedVelocity);
+    writer.write(position);
+    writer.write(fixedPosition);
+    writer.write(onTile);
+    writer.write(head);
+    writer.write(boundingBox);
+    writer.writeVector(claimedArea);
+    writer.writeVector(path);
+}
+
+void Player::restore(SnapshotReader &reader, int mapRadius)
+{
+    // a dry run checks that the player lies on the board, so the tiles
+    // it owns and claims can be indexed. Alive players are inside the border.
+    bool readDead = true;
+    float bound = 2 * (mapRadius + 1) * TILE_UNIT_SIZE;
+
+    auto onBoard = [&](Tile t) {
+        return abs(t.q) <= mapRadius && abs(t.r) <= mapRadius;
+    };
+    auto inside = [&](Tile t) {
+        return hexDistance(CENTER, t) < mapRadius || readDead;
+    };
+    auto isNear = [&](CartCoord c) {
+        return std::isfinite(c.x) && std::isfinite(c.y) && fabs(c.x) <= bound && fabs(c.y) <= bound;
+    };
+
+    reader.read(dead, [&](bool d) { readDead = d; return true; });
+    reader.read(winner);
+    reader.read(kills);
+    reader.read(captures);
+
+    // the velocity is given by the game
+    reader.read(velocity, [&](float v) { return v == velocity; });
+    reader.read(fixedVelocity, [&](int32_t v) { return v == fixedVelocity; });
+
+    reader.read(position, [&](CartCoord c) { return isNear(c) && inside(cartToTile(c)); });
+    reader.read(fixedPosition, [&](FixedCoord c) { return inside(fixedToTile(c)); });
+    reader.read(onTile);
+    reader.read(head, [&](Tile t) { return onBoard(t) && inside(t); });
+    reader.read(boundingBox, [&](TileBoundingBox b) {
+        return onBoard(b.min) && onBoard(b.max) && b.min.q <= b.max.q && b.min.r <= b.max.r;
+    });
+    reader.readVector(claimedArea, -1, [&](Tile t, size_t) { return onBoard(t); });
+    reader.readVector(path, -1, [&](CartCoord c, size_t) { return isNear(c); });
+}
@@ -7,9 +7,16 @@
 #include <iostream>
 #include <iomanip>
 #include <cstdlib>
-#include <ctime>
+#include <random>
+#include <mutex>
+#include <algorithm>
 #include "include/py_module.h"
 #include "include/controller.h"
+#include "include/vector_controller.h"
+#include "include/mcts.h"
+#ifndef _WIN32
+#include "include/env_server.h"
+#endif
 
 /**
  * https://www.tutorialspoint.com/python/python_further_extensions.htm
@@ -19,6 +26,86 @@ using namespace std;
 
 
 const char* identifier = "val";
+const char* vector_identifier = "vector";
+const char* mcts_identifier = "mcts";
+
+/**
+ * the GIL is released while the game or the renderers run, so python threads
+ * can step different controllers truly in parallel. Calls on the same controller
+ * are serialized by its mutex. The mutex is only locked without the GIL and 
+ * is released before the GIL is taken back, so the two locks cannot deadlock.
+ * Cheap getters lock the mutex but keep the GIL, which is safe for the same reason.
+ */
+#define BEGIN_NATIVE_CALL(controller) Py_BEGIN_ALLOW_THREADS { lock_guard<mutex> controllerLock((controller)->getMutex());
+#define END_NATIVE_CALL } Py_END_ALLOW_THREADS
+
+/**
+ * calls fn with a pointer of the matching type to the data of an array
+ * from get_actions_array
+ */
+template<typename F>
+static void with_typed_actions(PyArrayObject *actions, F fn)
+{
+    void *data = PyArray_DATA(actions);
+
+    switch (PyArray_TYPE(actions)) {
+        case NPY_BYTE: fn((const signed char *) data); break;
+        case NPY_INT: fn((const int *) data); break;
+        case NPY_LONG: fn((const long *) data); break;
+        case NPY_LONGLONG: fn((const long long *) data); break;
+        case NPY_DOUBLE: fn((const double *) data); break;
+        default: fn((const float *) data); break;
+    }
+}
+
+/**
+ * returns a new reference to the actions as array which the game can read in
+ * place. Aligned, contiguous int8, int32, int64, float32 and float64 arrays are
+ * used without a copy, anything else is converted to float32 once.
+ * Actions the game cannot take (see Game::isValidAction) raise a ValueError.
+ */
+static PyArrayObject* get_actions_array(PyObject *actionsArg, npy_intp numActions, bool discrete)
+{
+    int type = NPY_FLOAT32;
+
+    if (PyArray_Check(actionsArg)) {
+        switch (PyArray_TYPE((PyArrayObject *) actionsArg)) {
+            case NPY_BYTE:
+            case NPY_INT:
+            case NPY_LONG:
+            case NPY_LONGLONG:
+            case NPY_FLOAT:
+            case NPY_DOUBLE:
+                type = PyArray_TYPE((PyArrayObject *) actionsArg);
+                break;
+        }
+    }
+
+    // only copies if the array is not contiguous, aligned and in native byte order
+    PyArrayObject *actions = (PyArrayObject *) PyArray_FROMANY(actionsArg, type, 0, 0, NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST);
+    if (actions == NULL) return NULL;
+
+    if (PyArray_SIZE(actions) != numActions) {
+        Py_DECREF(actions);
+        PyErr_Format(PyExc_ValueError, "expected %ld actions, got %ld", (long) numActions, (long) PyArray_SIZE(actions));
+        return NULL;
+    }
+
+    bool valid = true;
+    with_typed_actions(actions, [&](auto *values) {
+        for (npy_intp i = 0; i < numActions && valid; i++) {
+            valid = Game::isValidAction(values[i], discrete);
+        }
+    });
+
+    if (!valid) {
+        Py_DECREF(actions);
+        PyErr_SetString(PyExc_ValueError, discrete ? "discrete actions must be between 0 and 5" : "actions must be finite");
+        return NULL;
+    }
+
+    return actions;
+}
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,10 +119,44 @@ void destroy_controller(PyObject *controller)
     delete (Controller *) PyCapsule_GetPointer(controller, identifier);
 }
 
+void destroy_vector_controller(PyObject *controller)
+{
+    // completes a pending step before the arrays it writes to are released
+    delete (VectorController *) PyCapsule_GetPointer(controller, vector_identifier);
+    Py_XDECREF((PyObject *) PyCapsule_GetContext(controller));
+}
+
+void destroy_mcts(PyObject *mcts)
+{
+    // the context keeps the searched controller alive
+    delete (Mcts *) PyCapsule_GetPointer(mcts, mcts_identifier);
+    Py_XDECREF((PyObject *) PyCapsule_GetContext(mcts));
+}
+
+/**
+ * reads the seed of a game, a new random seed is drawn for None
+ */
+static bool get_seed(PyObject *seedArg, uint64_t *seed)
+{
+    if (seedArg == NULL || seedArg == Py_None) {
+        random_device device;
+        *seed = ((uint64_t) device() << 32) | device();
+        return true;
+    }
+
+    if (!PyLong_Check(seedArg)) {
+        PyErr_SetString(PyExc_TypeError, "seed must be an int or None");
+        return false;
+    }
+
+    *seed = PyLong_AsUnsignedLongLongMask(seedArg);
+    return !PyErr_Occurred();
+}
+
 /**
  * this is like a constructor
  */
-static PyObject* setup(PyObject *self, PyObject *args)
+static PyObject* setup(PyObject *self, PyObject *args, PyObject *kwargs)
 {
     int mapRadius;
     int numPlayers;
@@ -46,9 +167,43 @@ static PyObject* setup(PyObject *self, PyObject *args)
     int pxObservationWidth;
     int pxObservationHeight;
     float defaultVelocity;
+    int pxSupersampling = OBS_SUPERSAMPLING;
+    int numRenderThreads = 1;
+    int sharedGlobalRender = false;
+    RewardWeights rewardWeights = DEFAULT_REWARD_WEIGHTS;
+    int maxSteps = DEFAULT_MAX_STEPS;
+    int autoReset = false;
+    PyObject *botsArg = NULL;
+    PyObject *seedArg = NULL;
+    int numHeadings = 0;
 
-    // parse the arguments
-    if (!PyArg_ParseTuple(args, "iiiiiiiif", 
+    static const char *kwlist[] = {
+        "map_radius",
+        "num_players",
+        "local_perspective",
+        "feature_observations",
+        "discrete_action_space",
+        "observation_radius",
+        "px_observation_width",
+        "px_observation_height",
+        "velocity",
+        "px_supersampling",
+        "render_threads",
+        "shared_global_render",
+        "reward_timestep",
+        "reward_capture",
+        "reward_claim",
+        "reward_kill",
+        "max_steps",
+        "auto_reset",
+        "bots",
+        "seed",
+        "headings",
+        NULL
+    };
+
+    // parse the arguments, everything after the velocity is optional
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "iiiiiiiif|$iipffffipOOi", (char **) kwlist,
         &mapRadius, 
         &numPlayers, 
         &localPerspective,
@@ -57,13 +212,82 @@ static PyObject* setup(PyObject *self, PyObject *args)
         &observationRadius, 
         &pxObservationWidth,
         &pxObservationHeight,
-        &defaultVelocity)) {
+        &defaultVelocity,
+        &pxSupersampling,
+        &numRenderThreads,
+        &sharedGlobalRender,
+        &rewardWeights.timestep,
+        &rewardWeights.capture,
+        &rewardWeights.claim,
+        &rewardWeights.kill,
+        &maxSteps,
+        &autoReset,
+        &botsArg,
+        &seedArg,
+        &numHeadings)) {
         return NULL;
     }
 
-    // initialize random number generator
-    srand(time(NULL));
-    
+    // one BOT_* type per player slot, the remaining slots are agents
+    vector<int> botTypes;
+
+    if (botsArg != NULL && botsArg != Py_None) {
+        PyObject *sequence = PySequence_Fast(botsArg, "bots must be a sequence of BOT_* types");
+        if (sequence == NULL) return NULL;
+
+        for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(sequence); i++) {
+            long type = PyLong_AsLong(PySequence_Fast_GET_ITEM(sequence, i));
+            if (type == -1 && PyErr_Occurred()) {
+                Py_DECREF(sequence);
+                return NULL;
+            }
+            botTypes.push_back((int) type);
+        }
+        Py_DECREF(sequence);
+
+        if ((int) botTypes.size() > numPlayers) {
+            PyErr_SetString(PyExc_ValueError, "more bots than players");
+            return NULL;
+        }
+
+        for (int type : botTypes) {
+            if (type < BOT_NONE || type > BOT_DEFENSIVE) {
+                PyErr_SetString(PyExc_ValueError, "bots must be a sequence of BOT_* types");
+                return NULL;
+            }
+        }
+    }
+
+    if (pxSupersampling < 1) {
+        PyErr_SetString(PyExc_ValueError, "px_supersampling must be at least 1");
+        return NULL;
+    }
+
+    if (numRenderThreads < 1) {
+        PyErr_SetString(PyExc_ValueError, "render_threads must be at least 1");
+        return NULL;
+    }
+
+    if (maxSteps < 1) {
+        PyErr_SetString(PyExc_ValueError, "max_steps must be at least 1");
+        return NULL;
+    }
+
+    if (numHeadings < 0) {
+        PyErr_SetString(PyExc_ValueError, "headings must not be negative");
+        return NULL;
+    }
+
+#ifdef HEXARIO_HEADLESS
+    if (!featureObservations) {
+        PyErr_SetString(PyExc_RuntimeError, "game_module was built without SDL, pixel observations are not available");
+        return NULL;
+    }
+#endif
+
+    uint64_t seed;
+    if (!get_seed(seedArg, &seed)) return NULL;
+
     // yes, this allocates space on the heap
     Controller *controller = new Controller(
         mapRadius,
@@ -74,7 +298,16 @@ static PyObject* setup(PyObject *self, PyObject *args)
         observationRadius,
         pxObservationWidth,
         pxObservationHeight,
-        defaultVelocity
+        defaultVelocity,
+        pxSupersampling,
+        numRenderThreads,
+        sharedGlobalRender == true,
+        rewardWeights,
+        maxSteps,
+        autoReset == true,
+        botTypes,
+        seed,
+        numHeadings
     );
 
     // return something
@@ -97,136 +330,128 @@ static PyObject* reset_player(PyObject *self, PyObject *args)
         return NULL;
     }
 
+    if (playerId < 0 || playerId >= controller->getNumPlayers()) {
+        PyErr_Format(PyExc_ValueError, "player_id must be between 0 and %d", controller->getNumPlayers() - 1);
+        return NULL;
+    }
+
+    BEGIN_NATIVE_CALL(controller)
     controller->resetPlayer(playerId);
+    END_NATIVE_CALL
 
     // return something
     Py_RETURN_NONE;
 }
 
-
 /**
-* apply a set of actions, one for each player.
-* num of actions must match num of players.
-*/
-static PyObject* take_actions(PyObject *self, PyObject *args)
+ * respawns all players of the game
+ */
+static PyObject* reset_all(PyObject *self, PyObject *args)
 {
     PyObject *ptr = NULL;
-    PyArrayObject *arr = NULL;
 
-    if (!PyArg_ParseTuple(args, "OO", &ptr, &arr)) return NULL;
+    if (!PyArg_ParseTuple(args, "O", &ptr)) return NULL;
 
-    // retrieve the controller from ptr object
     Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
     if (controller == NULL) {
-        cout << "controller is Null, this must not happen!" << endl;
         return NULL;
     }
 
-    // get the array
-    std::vector<float> actions;
-
-    for (int i = 0; i < PyArray_SIZE(arr); i++) {
-        float *action = (float *) PyArray_GETPTR1(arr, i);
-        actions.push_back(*action);
-    }
+    BEGIN_NATIVE_CALL(controller)
+    controller->resetAll();
+    END_NATIVE_CALL
 
-    controller->takeActions(actions);
-    
-    // return something
     Py_RETURN_NONE;
 }
 
-
-
 /**
-* just a test for returning a numpy array 
-*/
-static PyObject* get_observation(PyObject *self, PyObject *args)
+ * seeds the random numbers of the game, None draws a new random seed
+ */
+static PyObject* seed(PyObject *self, PyObject *args)
 {
     PyObject *ptr = NULL;
-    int playerId;
-   
-    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+    PyObject *seedArg = NULL;
+
+    if (!PyArg_ParseTuple(args, "OO", &ptr, &seedArg)) return NULL;
+
+    uint64_t seed;
+    if (!get_seed(seedArg, &seed)) return NULL;
 
-    // retrieve the controller from ptr object
     Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
     if (controller == NULL) {
-        cout << "controller is Null, this must not happen!" << endl;
         return NULL;
     }
 
-    // construct numpy array
-    long observationSize = controller->getObservationSize();
-    int n_dims = 1;
-    npy_intp mdims[] = {observationSize};
-    PyArrayObject *observation;
-    observation = (PyArrayObject *) PyArray_SimpleNew(n_dims, mdims, NPY_FLOAT32);
-    controller->getObservation(playerId, (float *) PyArray_DATA(observation), observationSize);
-    
-    return PyArray_Return(observation);
+    BEGIN_NATIVE_CALL(controller)
+    controller->seed(seed);
+    END_NATIVE_CALL
+
+    Py_RETURN_NONE;
 }
 
 /**
- * 
+ * returns the state of the game as bytes, restore sets the game back to it
  */
-static PyObject* is_dead(PyObject *self, PyObject *args)
+static PyObject* snapshot(PyObject *self, PyObject *args)
 {
-    // parse arguments
     PyObject *ptr = NULL;
-    int playerId;
-   
-    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
 
-    // retrieve the controller from ptr object
+    if (!PyArg_ParseTuple(args, "O", &ptr)) return NULL;
+
     Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
     if (controller == NULL) {
-        cout << "controller is Null, this must not happen!" << endl;
         return NULL;
     }
 
-    if (controller->isDead(playerId)) {
-        Py_RETURN_TRUE;
-    } else {
-        Py_RETURN_FALSE;
-    }
-}
+    lock_guard<mutex> controllerLock(controller->getMutex());
+    const vector<char> &data = controller->snapshot();
 
+    return PyBytes_FromStringAndSize(data.data(), (Py_ssize_t) data.size());
+}
 
 /**
- * 
+ * restores a snapshot of a game with the same configuration,
+ * accepts bytes or any other contiguous buffer
  */
-static PyObject* is_winner(PyObject *self, PyObject *args)
+static PyObject* restore(PyObject *self, PyObject *args)
 {
-    // parse arguments
     PyObject *ptr = NULL;
-    int playerId;
-   
-    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+    Py_buffer buffer;
+
+    if (!PyArg_ParseTuple(args, "Oy*", &ptr, &buffer)) return NULL;
 
-    // retrieve the controller from ptr object
     Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
     if (controller == NULL) {
-        cout << "controller is Null, this must not happen!" << endl;
+        PyBuffer_Release(&buffer);
         return NULL;
     }
 
-    if (controller->isWinner(playerId)) {
-        Py_RETURN_TRUE;
-    } else {
-        Py_RETURN_FALSE;
+    bool restored;
+    BEGIN_NATIVE_CALL(controller)
+    restored = controller->restore((const char *) buffer.buf, (size_t) buffer.len);
+    END_NATIVE_CALL
+
+    PyBuffer_Release(&buffer);
+
+    if (!restored) {
+        PyErr_SetString(PyExc_ValueError, "snapshot is corrupted or does not match the game");
+        return NULL;
     }
+
+    Py_RETURN_NONE;
 }
 
+
 /**
- * 
- */
-static PyObject* get_num_kills(PyObject *self, PyObject *args)
+* apply a set of actions, one for each player.
+* num of actions must match num of players.
+*/
+static PyObject* take_actions(PyObject *self, PyObject *args)
 {
-    // parse arguments
     PyObject *ptr = NULL;
-    int playerId;
-   
-    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+    PyObject *actionsArg = NULL;
+
+    if (!PyArg_ParseTuple(args, "OO", &ptr, &actionsArg)) return NULL;
 
     // retrieve the controller from ptr object
     Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
@@ -235,58 +460,220 @@ static PyObject* get_num_kills(PyObject *self, PyObject *args)
         return NULL;
     }
 
-    int numKills = controller->getNumKills(playerId);
+    // the actions are read in place
+    PyArrayObject *actions = get_actions_array(actionsArg, controller->getNumPlayers(), controller->isActionSpaceDiscrete());
+    if (actions == NULL) return NULL;
 
-    return PyLong_FromLong((long) numKills);
+    BEGIN_NATIVE_CALL(controller)
+    with_typed_actions(actions, [controller](auto *actionsAddr) {
+        controller->takeActions(actionsAddr);
+    });
+    END_NATIVE_CALL
+
+    Py_DECREF(actions);
+    
+    // return something
+    Py_RETURN_NONE;
 }
 
-static PyObject* get_num_captures(PyObject *self, PyObject *args)
+/**
+ * returns a new reference to the array a function writes its result to.
+ * If out is NULL or None, a new array of shape dims is allocated. Otherwise
+ * out is checked once and used, it must be a writeable, aligned, C-contiguous
+ * array with the dtype descr and as many elements as dims, its shape may 
+ * differ (e.g. pixel observations as (height, width, 3)). Steals descr.
+ */
+static PyArrayObject* get_output_array(PyObject *out, const char *name, int nd, npy_intp *dims, PyArray_Descr *descr)
 {
-    // parse arguments
-    PyObject *ptr = NULL;
-    int playerId;
-   
-    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+    if (descr == NULL) return NULL;
 
-    // retrieve the controller from ptr object
-    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
-    if (controller == NULL) {
-        cout << "controller is Null, this must not happen!" << endl;
+    if (out == NULL || out == Py_None) {
+        return (PyArrayObject *) PyArray_NewFromDescr(&PyArray_Type, descr, nd, dims, NULL, NULL, 0, NULL);
+    }
+
+    if (!PyArray_Check(out)) {
+        Py_DECREF(descr);
+        PyErr_Format(PyExc_TypeError, "%s must be a numpy array", name);
         return NULL;
     }
 
-    int numCaptures = controller->getNumCaptures(playerId);
+    PyArrayObject *arr = (PyArrayObject *) out;
 
-    return PyLong_FromLong((long) numCaptures);
+    npy_intp size = 1;
+    for (int i = 0; i < nd; i++) {
+        size *= dims[i];
+    }
+
+    bool isEquivalent = PyArray_EquivTypes(PyArray_DESCR(arr), descr);
+    Py_DECREF(descr);
+
+    if (!PyArray_IS_C_CONTIGUOUS(arr) || !PyArray_ISWRITEABLE(arr) || !PyArray_ISALIGNED(arr)) {
+        PyErr_Format(PyExc_ValueError, "%s must be a writeable, aligned and C-contiguous array", name);
+        return NULL;
+    }
+
+    if (!isEquivalent) {
+        PyErr_Format(PyExc_TypeError, "%s has the wrong dtype", name);
+        return NULL;
+    }
+
+    if (PyArray_SIZE(arr) != size) {
+        PyErr_Format(PyExc_ValueError, "%s must have %ld elements", name, (long) size);
+        return NULL;
+    }
+
+    Py_INCREF(arr);
+    return arr;
 }
 
-static PyObject* get_num_claims(PyObject *self, PyObject *args)
+/**
+ * returns the structured dtype of the info records with the INFO_* fields
+ * set in infoFields. The dtypes are created once and cached.
+ */
+static PyArray_Descr* get_info_descr(int infoFields)
+{
+    static PyArray_Descr *cache[INFO_ALL + 1] = {NULL};
+
+    if (cache[infoFields] != NULL) {
+        Py_INCREF(cache[infoFields]);
+        return cache[infoFields];
+    }
+
+    // same order as the records written by Controller::getInfo
+    PyObject *fields = PyList_New(0);
+    if (fields == NULL) return NULL;
+
+    if (infoFields & INFO_KILLS) PyList_Append(fields, Py_BuildValue("(ss)", "num_kills", "<i4"));
+    if (infoFields & INFO_CAPTURES) PyList_Append(fields, Py_BuildValue("(ss)", "num_captures", "<i4"));
+    if (infoFields & INFO_CLAIMS) PyList_Append(fields, Py_BuildValue("(ss)", "num_claims", "<i4"));
+    if (infoFields & INFO_COVERAGE) PyList_Append(fields, Py_BuildValue("(ss)", "coverage", "<f4"));
+    if (infoFields & INFO_WINNER) PyList_Append(fields, Py_BuildValue("(ss)", "success", "?"));
+    if (infoFields & INFO_DEAD) PyList_Append(fields, Py_BuildValue("(ss)", "dead", "?"));
+    if (infoFields & INFO_DISTANCES) PyList_Append(fields, Py_BuildValue("(ss(i))", "distances", "<f4", 6));
+    if (infoFields & INFO_STEPS) PyList_Append(fields, Py_BuildValue("(ss)", "steps", "<i4"));
+    if (infoFields & INFO_RESET) PyList_Append(fields, Py_BuildValue("(ss)", "reset", "?"));
+
+    // the appended tuples are owned by the list now
+    for (Py_ssize_t i = 0; i < PyList_GET_SIZE(fields); i++) {
+        Py_DECREF(PyList_GET_ITEM(fields, i));
+    }
+
+    PyArray_Descr *descr = NULL;
+    int converted = PyArray_DescrConverter(fields, &descr);
+    Py_DECREF(fields);
+
+    if (!converted) return NULL;
+
+    cache[infoFields] = descr;
+    Py_INCREF(descr);
+    return descr;
+}
+
+static bool check_info_fields(int infoFields)
+{
+    if (infoFields < 0 || infoFields > INFO_ALL) {
+        PyErr_SetString(PyExc_ValueError, "info_fields must be a combination of the INFO_* flags");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * takes one action per player and returns everything the environment
+ * needs after a step: (observations, rewards, dones, info).
+ * observations has the shape (numAgents, observationSize) and holds the
+ * players 0 .. numAgents-1, rewards and dones hold every player. info is
+ * a structured array with one record per player, holding the fields 
+ * selected by the info_fields bitmask (INFO_KILLS | INFO_CAPTURES ...).
+ * With auto_reset, done players are respawned within the step, their
+ * observation is the first of the new episode and INFO_RESET flags them.
+ * The results are written to obs_out, rewards_out, dones_out and info_out
+ * if they are given, see get_output_array.
+ */
+static PyObject* step(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    // parse arguments
     PyObject *ptr = NULL;
-    int playerId;
-   
-    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+    PyObject *actionsArg = NULL;
+    int numAgents;
+    int infoFields = INFO_ALL;
+    PyObject *obsOut = NULL;
+    PyObject *rewardsOut = NULL;
+    PyObject *donesOut = NULL;
+    PyObject *infoOut = NULL;
+
+    static const char *kwlist[] = {
+        "controller", "actions", "num_agents", "info_fields",
+        "obs_out", "rewards_out", "dones_out", "info_out", NULL
+    };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOi|$iOOOO", (char **) kwlist,
+        &ptr, &actionsArg, &numAgents, &infoFields, &obsOut, &rewardsOut, &donesOut, &infoOut)) {
+        return NULL;
+    }
+
+    if (!check_info_fields(infoFields)) return NULL;
 
-    // retrieve the controller from ptr object
     Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
     if (controller == NULL) {
         cout << "controller is Null, this must not happen!" << endl;
         return NULL;
     }
 
-    int numCaptures = controller->getNumClaims(playerId);
+    int numPlayers = controller->getNumPlayers();
 
-    return PyLong_FromLong((long) numCaptures);
+    if (numAgents < 0 || numAgents > numPlayers) {
+        PyErr_SetString(PyExc_ValueError, "num_agents must be between 0 and the number of players");
+        return NULL;
+    }
+
+    PyArrayObject *actions = get_actions_array(actionsArg, numPlayers, controller->isActionSpaceDiscrete());
+    if (actions == NULL) return NULL;
+
+    npy_intp obsDims[] = {numAgents, controller->getObservationSize()};
+    npy_intp dims[] = {numPlayers};
+    PyArrayObject *observations = get_output_array(obsOut, "obs_out", 2, obsDims, PyArray_DescrFromType(NPY_FLOAT32));
+    PyArrayObject *rewards = observations ? get_output_array(rewardsOut, "rewards_out", 1, dims, PyArray_DescrFromType(NPY_FLOAT32)) : NULL;
+    PyArrayObject *dones = rewards ? get_output_array(donesOut, "dones_out", 1, dims, PyArray_DescrFromType(NPY_BOOL)) : NULL;
+    PyArrayObject *info = dones ? get_output_array(infoOut, "info_out", 1, dims, get_info_descr(infoFields)) : NULL;
+
+    if (!info) {
+        Py_DECREF(actions);
+        Py_XDECREF(observations);
+        Py_XDECREF(rewards);
+        Py_XDECREF(dones);
+        return NULL;
+    }
+
+    long observationSize = controller->getObservationSize();
+    float *obsAddr = (float *) PyArray_DATA(observations);
+    float *rewardsAddr = (float *) PyArray_DATA(rewards);
+    bool *donesAddr = (bool *) PyArray_DATA(dones);
+    char *infoAddr = (char *) PyArray_DATA(info);
+
+    BEGIN_NATIVE_CALL(controller)
+    with_typed_actions(actions, [&](auto *actionsAddr) {
+        controller->step(actionsAddr, rewardsAddr, donesAddr, infoFields, infoAddr);
+    });
+    controller->getObservations(numAgents, obsAddr, numAgents * observationSize);
+    END_NATIVE_CALL
+
+    Py_DECREF(actions);
+
+    return Py_BuildValue("NNNN", observations, rewards, dones, info);
 }
 
-static PyObject* get_distances(PyObject *self, PyObject *args)
+/**
+ * returns the observation of one player, written to out if it is given
+ */
+static PyObject* get_observation(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    // parse arguments
     PyObject *ptr = NULL;
     int playerId;
+    PyObject *out = NULL;
 
-    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+    static const char *kwlist[] = {"controller", "player_id", "out", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|$O", (char **) kwlist, &ptr, &playerId, &out)) return NULL;
 
     // retrieve the controller from ptr object
     Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
@@ -295,21 +682,35 @@ static PyObject* get_distances(PyObject *self, PyObject *args)
         return NULL;
     }
 
-    std::vector<float> dists = controller->getDistancesToBorder(playerId);
+    // construct numpy array
+    long observationSize = controller->getObservationSize();
+    int n_dims = 1;
+    npy_intp mdims[] = {observationSize};
+    PyArrayObject *observation = get_output_array(out, "out", n_dims, mdims, PyArray_DescrFromType(NPY_FLOAT32));
+    if (observation == NULL) return NULL;
 
-    return Py_BuildValue("dddddd", dists[0], dists[1], dists[2], dists[3], dists[4], dists[5]);
+    float *obsMemAddr = (float *) PyArray_DATA(observation);
+    BEGIN_NATIVE_CALL(controller)
+    controller->getObservation(playerId, obsMemAddr, observationSize);
+    END_NATIVE_CALL
+    
+    return PyArray_Return(observation);
 }
 
-
-
 /**
- * returns true if a quit event was fired from the demo window
+ * returns the observations of the players 0 .. numAgents-1 
+ * as one array of shape (numAgents, observationSize),
+ * written to out if it is given
  */
-static PyObject* show(PyObject *self, PyObject *args) 
+static PyObject* get_observations(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    // parse arguments
     PyObject *ptr = NULL;
-    if (!PyArg_ParseTuple(args, "O", &ptr)) return NULL;
+    int numAgents;
+    PyObject *out = NULL;
+
+    static const char *kwlist[] = {"controller", "num_agents", "out", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|$O", (char **) kwlist, &ptr, &numAgents, &out)) return NULL;
 
     // retrieve the controller from ptr object
     Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
@@ -318,37 +719,1161 @@ static PyObject* show(PyObject *self, PyObject *args)
         return NULL;
     }
 
-    bool quit = controller->show();
-
-    if (quit) {
-        Py_RETURN_TRUE;
-    } else {
-        Py_RETURN_FALSE;
-    }
-}
+    // construct numpy array
+    long observationSize = controller->getObservationSize();
+    int n_dims = 2;
+    npy_intp mdims[] = {numAgents, observationSize};
+    PyArrayObject *observations = get_output_array(out, "out", n_dims, mdims, PyArray_DescrFromType(NPY_FLOAT32));
+    if (observations == NULL) return NULL;
 
-#ifdef __cplusplus
+    float *obsMemAddr = (float *) PyArray_DATA(observations);
+    BEGIN_NATIVE_CALL(controller)
+    controller->getObservations(numAgents, obsMemAddr, numAgents * observationSize);
+    END_NATIVE_CALL
+    
+    return PyArray_Return(observations);
 }
-#endif
-
+
+/**
+ * returns (safe, danger), the uint8 action masks of the players 0 .. numAgents-1,
+ * written to safe_out and danger_out if they are given. Bit i is set for
+ * direction i, see Game::getActionMasks.
+ */
+static PyObject* get_action_masks(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *ptr = NULL;
+    int numAgents;
+    PyObject *safeOut = NULL;
+    PyObject *dangerOut = NULL;
+
+    static const char *kwlist[] = {"controller", "num_agents", "safe_out", "danger_out", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|$OO", (char **) kwlist,
+        &ptr, &numAgents, &safeOut, &dangerOut)) return NULL;
+
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        return NULL;
+    }
+
+    if (numAgents < 0 || numAgents > controller->getNumPlayers()) {
+        PyErr_Format(PyExc_ValueError, "num_agents must be between 0 and %d", controller->getNumPlayers());
+        return NULL;
+    }
+
+    npy_intp dims[] = {numAgents};
+    PyArrayObject *safe = get_output_array(safeOut, "safe_out", 1, dims, PyArray_DescrFromType(NPY_UINT8));
+    PyArrayObject *danger = safe ? get_output_array(dangerOut, "danger_out", 1, dims, PyArray_DescrFromType(NPY_UINT8)) : NULL;
+    if (danger == NULL) {
+        Py_XDECREF(safe);
+        return NULL;
+    }
+
+    unsigned char *safeAddr = (unsigned char *) PyArray_DATA(safe);
+    unsigned char *dangerAddr = (unsigned char *) PyArray_DATA(danger);
+    BEGIN_NATIVE_CALL(controller)
+    controller->getActionMasks(numAgents, safeAddr, dangerAddr);
+    END_NATIVE_CALL
+
+    return Py_BuildValue("NN", safe, danger);
+}
+
+/**
+ * returns the structured dtype of GameEvent, with the index of the game
+ * in front for VectorEvent. The dtypes are created once and cached.
+ */
+static PyArray_Descr* get_event_descr(bool withEnv)
+{
+    static PyArray_Descr *cache[2] = {NULL, NULL};
+
+    if (cache[withEnv] != NULL) {
+        Py_INCREF(cache[withEnv]);
+        return cache[withEnv];
+    }
+
+    // same layout as GameEvent
+    PyObject *fields = withEnv
+        ? Py_BuildValue("[(ss)(ss)(ss)(ss)(ss)(ss)(ss)]", "env", "<i4", "type", "<i4", "player", "<i4",
+                        "other", "<i4", "value", "<i4", "q", "<i4", "r", "<i4")
+        : Py_BuildValue("[(ss)(ss)(ss)(ss)(ss)(ss)]", "type", "<i4", "player", "<i4",
+                        "other", "<i4", "value", "<i4", "q", "<i4", "r", "<i4");
+    if (fields == NULL) return NULL;
+
+    PyArray_Descr *descr = NULL;
+    int converted = PyArray_DescrConverter(fields, &descr);
+    Py_DECREF(fields);
+
+    if (!converted) return NULL;
+
+    cache[withEnv] = descr;
+    Py_INCREF(descr);
+    return descr;
+}
+
+/**
+ * returns the events since the last step as structured array with the
+ * fields type, player, other, value, q and r, see GameEvent
+ */
+static PyObject* get_events(PyObject *self, PyObject *args)
+{
+    PyObject *ptr = NULL;
+
+    if (!PyArg_ParseTuple(args, "O", &ptr)) return NULL;
+
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        return NULL;
+    }
+
+    PyArray_Descr *descr = get_event_descr(false);
+    if (descr == NULL) return NULL;
+
+    lock_guard<mutex> controllerLock(controller->getMutex());
+    const vector<GameEvent> &events = controller->getGame().getEvents();
+
+    npy_intp dims[] = {(npy_intp) events.size()};
+    PyArrayObject *arr = (PyArrayObject *) PyArray_NewFromDescr(&PyArray_Type, descr, 1, dims, NULL, NULL, 0, NULL);
+    if (arr == NULL) return NULL;
+
+    if (!events.empty()) {
+        memcpy(PyArray_DATA(arr), events.data(), events.size() * sizeof(GameEvent));
+    }
+
+    return (PyObject *) arr;
+}
+
+/**
+ * 
+ */
+static PyObject* is_dead(PyObject *self, PyObject *args)
+{
+    // parse arguments
+    PyObject *ptr = NULL;
+    int playerId;
+   
+    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+
+    // retrieve the controller from ptr object
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        cout << "controller is Null, this must not happen!" << endl;
+        return NULL;
+    }
+
+    bool dead;
+    {
+        lock_guard<mutex> controllerLock(controller->getMutex());
+        dead = controller->isDead(playerId);
+    }
+
+    if (dead) {
+        Py_RETURN_TRUE;
+    } else {
+        Py_RETURN_FALSE;
+    }
+}
+
+
+/**
+ * 
+ */
+static PyObject* is_winner(PyObject *self, PyObject *args)
+{
+    // parse arguments
+    PyObject *ptr = NULL;
+    int playerId;
+   
+    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+
+    // retrieve the controller from ptr object
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        cout << "controller is Null, this must not happen!" << endl;
+        return NULL;
+    }
+
+    bool winner;
+    {
+        lock_guard<mutex> controllerLock(controller->getMutex());
+        winner = controller->isWinner(playerId);
+    }
+
+    if (winner) {
+        Py_RETURN_TRUE;
+    } else {
+        Py_RETURN_FALSE;
+    }
+}
+
+/**
+ * 
+ */
+static PyObject* get_num_kills(PyObject *self, PyObject *args)
+{
+    // parse arguments
+    PyObject *ptr = NULL;
+    int playerId;
+   
+    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+
+    // retrieve the controller from ptr object
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        cout << "controller is Null, this must not happen!" << endl;
+        return NULL;
+    }
+
+    int numKills;
+    {
+        lock_guard<mutex> controllerLock(controller->getMutex());
+        numKills = controller->getNumKills(playerId);
+    }
+
+    return PyLong_FromLong((long) numKills);
+}
+
+static PyObject* get_num_captures(PyObject *self, PyObject *args)
+{
+    // parse arguments
+    PyObject *ptr = NULL;
+    int playerId;
+   
+    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+
+    // retrieve the controller from ptr object
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        cout << "controller is Null, this must not happen!" << endl;
+        return NULL;
+    }
+
+    int numCaptures;
+    {
+        lock_guard<mutex> controllerLock(controller->getMutex());
+        numCaptures = controller->getNumCaptures(playerId);
+    }
+
+    return PyLong_FromLong((long) numCaptures);
+}
+
+static PyObject* get_num_claims(PyObject *self, PyObject *args)
+{
+    // parse arguments
+    PyObject *ptr = NULL;
+    int playerId;
+   
+    if (!PyArg_ParseTuple(args, "Oi", &ptr, &playerId)) return NULL;
+
+    // retrieve the controller from ptr object
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        cout << "controller is Null, this must not happen!" << endl;
+        return NULL;
+    }
+
+    int numCaptures;
+    {
+        lock_guard<mutex> controllerLock(controller->getMutex());
+        numCaptures = controller->getNumClaims(playerId);
+    }
+
+    return PyLong_FromLong((long) numCaptures);
+}
+
+/**
+ * returns the distances of a player to the border in all six directions as
+ * tuple, or written to out (six float32) if it is given
+ */
+static PyObject* get_distances(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    // parse arguments
+    PyObject *ptr = NULL;
+    int playerId;
+    PyObject *out = NULL;
+
+    static const char *kwlist[] = {"controller", "player_id", "out", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|$O", (char **) kwlist, &ptr, &playerId, &out)) return NULL;
+
+    // retrieve the controller from ptr object
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        cout << "controller is Null, this must not happen!" << endl;
+        return NULL;
+    }
+
+    std::vector<float> dists;
+    {
+        lock_guard<mutex> controllerLock(controller->getMutex());
+        dists = controller->getDistancesToBorder(playerId);
+    }
+
+    if (out == NULL || out == Py_None) {
+        return Py_BuildValue("dddddd", dists[0], dists[1], dists[2], dists[3], dists[4], dists[5]);
+    }
+
+    npy_intp dims[] = {6};
+    PyArrayObject *distances = get_output_array(out, "out", 1, dims, PyArray_DescrFromType(NPY_FLOAT32));
+    if (distances == NULL) return NULL;
+
+    copy(dists.begin(), dists.end(), (float *) PyArray_DATA(distances));
+
+    return (PyObject *) distances;
+}
+
+/**
+ * returns true if a quit event was fired from the demo window
+ */
+static PyObject* show(PyObject *self, PyObject *args) 
+{
+    // parse arguments
+    PyObject *ptr = NULL;
+    if (!PyArg_ParseTuple(args, "O", &ptr)) return NULL;
+
+    // retrieve the controller from ptr object
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        cout << "controller is Null, this must not happen!" << endl;
+        return NULL;
+    }
+
+#ifdef HEXARIO_HEADLESS
+    PyErr_SetString(PyExc_RuntimeError, "game_module was built without SDL, the game cannot be shown");
+    return NULL;
+#else
+    // the window must be shown from the main thread, so the GIL is kept
+    bool quit;
+    {
+        lock_guard<mutex> controllerLock(controller->getMutex());
+        quit = controller->show();
+    }
+
+    if (quit) {
+        Py_RETURN_TRUE;
+    } else {
+        Py_RETURN_FALSE;
+    }
+#endif
+}
+
+/**
+ * starts recording the demo view of every step in the background.
+ * format is "y4m" (path is the video file) or "ppm" (path is the
+ * prefix of the image files)
+ */
+static PyObject* start_recording(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *ptr = NULL;
+    const char *path;
+    const char *format = "y4m";
+    int width = WIN_WIDTH;
+    int height = WIN_HEIGHT;
+    int queueSize = RECORDING_DEFAULT_QUEUE_SIZE;
+
+    static const char *kwlist[] = {"controller", "path", "format", "width", "height", "queue_size", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Os|$siii", (char **) kwlist,
+        &ptr, &path, &format, &width, &height, &queueSize)) {
+        return NULL;
+    }
+
+    // retrieve the controller from ptr object
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        cout << "controller is Null, this must not happen!" << endl;
+        return NULL;
+    }
+
+#ifdef HEXARIO_HEADLESS
+    PyErr_SetString(PyExc_RuntimeError, "game_module was built without SDL, the game cannot be recorded");
+    return NULL;
+#else
+    int recordingFormat = RECORDING_Y4M;
+    if (string(format) == "y4m") {
+        recordingFormat = RECORDING_Y4M;
+    } else if (string(format) == "ppm") {
+        recordingFormat = RECORDING_PPM;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "format must be 'y4m' or 'ppm'");
+        return NULL;
+    }
+
+    if (width <= 0 || height <= 0 || queueSize <= 0) {
+        PyErr_SetString(PyExc_ValueError, "width, height and queue_size must be positive");
+        return NULL;
+    }
+
+    bool started;
+    BEGIN_NATIVE_CALL(controller)
+    started = controller->startRecording(path, recordingFormat, width, height, queueSize);
+    END_NATIVE_CALL
+
+    if (!started) {
+        PyErr_Format(PyExc_OSError, "cannot record to %s", path);
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+#endif
+}
+
+/**
+ * finishes the recording and returns the tuple 
+ * (number of written frames, number of dropped frames),
+ * or None if nothing was recorded
+ */
+static PyObject* stop_recording(PyObject *self, PyObject *args)
+{
+    PyObject *ptr = NULL;
+    if (!PyArg_ParseTuple(args, "O", &ptr)) return NULL;
+
+    // retrieve the controller from ptr object
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        cout << "controller is Null, this must not happen!" << endl;
+        return NULL;
+    }
+
+    long numWritten = 0;
+    long numDropped = 0;
+
+    bool stopped;
+    BEGIN_NATIVE_CALL(controller)
+    stopped = controller->stopRecording(numWritten, numDropped);
+    END_NATIVE_CALL
+
+    if (!stopped) {
+        Py_RETURN_NONE;
+    }
+
+    return Py_BuildValue("ll", numWritten, numDropped);
+}
+
+/**
+ * constructor of the vectorized environment, takes the number of 
+ * environments and then the same arguments as setup, where the number
+ * of players is the number of agents per environment
+ */
+static PyObject* setup_vector(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    int numEnvs;
+    int mapRadius;
+    int numAgents;
+    int localPerspective;
+    int featureObservations;
+    int discreteActionSpace;
+    int observationRadius;
+    int pxObservationWidth;
+    int pxObservationHeight;
+    float defaultVelocity;
+    int pxSupersampling = OBS_SUPERSAMPLING;
+    int sharedGlobalRender = false;
+    RewardWeights rewardWeights = DEFAULT_REWARD_WEIGHTS;
+    int maxSteps = DEFAULT_MAX_STEPS;
+    int numThreads = 1;
+    int pinThreads = false;
+    PyObject *seedArg = NULL;
+    int numHeadings = 0;
+
+    static const char *kwlist[] = {
+        "num_envs",
+        "map_radius",
+        "num_agents",
+        "local_perspective",
+        "feature_observations",
+        "discrete_action_space",
+        "observation_radius",
+        "px_observation_width",
+        "px_observation_height",
+        "velocity",
+        "px_supersampling",
+        "shared_global_render",
+        "reward_timestep",
+        "reward_capture",
+        "reward_claim",
+        "reward_kill",
+        "max_steps",
+        "num_threads",
+        "pin_threads",
+        "seed",
+        "headings",
+        NULL
+    };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "iiiiiiiiif|$ipffffiipOi", (char **) kwlist,
+        &numEnvs,
+        &mapRadius, 
+        &numAgents, 
+        &localPerspective,
+        &featureObservations, 
+        &discreteActionSpace, 
+        &observationRadius, 
+        &pxObservationWidth,
+        &pxObservationHeight,
+        &defaultVelocity,
+        &pxSupersampling,
+        &sharedGlobalRender,
+        &rewardWeights.timestep,
+        &rewardWeights.capture,
+        &rewardWeights.claim,
+        &rewardWeights.kill,
+        &maxSteps,
+        &numThreads,
+        &pinThreads,
+        &seedArg,
+        &numHeadings)) {
+        return NULL;
+    }
+
+    if (numEnvs < 1 || numAgents < 1 || pxSupersampling < 1 || maxSteps < 1 || numThreads < 1) {
+        PyErr_SetString(PyExc_ValueError, "num_envs, num_agents, px_supersampling, max_steps and num_threads must be at least 1");
+        return NULL;
+    }
+
+    if (numHeadings < 0) {
+        PyErr_SetString(PyExc_ValueError, "headings must not be negative");
+        return NULL;
+    }
+
+#ifdef HEXARIO_HEADLESS
+    if (!featureObservations) {
+        PyErr_SetString(PyExc_RuntimeError, "game_module was built without SDL, pixel observations are not available");
+        return NULL;
+    }
+#endif
+
+    uint64_t seed;
+    if (!get_seed(seedArg, &seed)) return NULL;
+
+    VectorController *controller = new VectorController(
+        numEnvs,
+        numAgents,
+        mapRadius,
+        localPerspective == true,
+        featureObservations == true,
+        discreteActionSpace == true,
+        observationRadius,
+        pxObservationWidth,
+        pxObservationHeight,
+        defaultVelocity,
+        pxSupersampling,
+        sharedGlobalRender == true,
+        rewardWeights,
+        maxSteps,
+        numThreads,
+        pinThreads == true,
+        seed,
+        numHeadings
+    );
+
+    return PyCapsule_New((void *) controller, vector_identifier, destroy_vector_controller);
+}
+
+/**
+ * the arrays of a pending step_async are stored as context of the capsule,
+ * which keeps them alive until step_wait. Raises if there is one.
+ */
+static bool check_no_pending_step(PyObject *capsule)
+{
+    if (PyCapsule_GetContext(capsule) != NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "an asynchronous step is pending, call step_wait first");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * returns the array for the observations of all agents, of shape 
+ * (numEnvs, numAgents, observationSize)
+ */
+static PyArrayObject* get_vector_observations(VectorController *controller, PyObject *out, const char *name)
+{
+    npy_intp dims[] = {controller->getNumEnvs(), controller->getNumAgents(), controller->getObservationSize()};
+    return get_output_array(out, name, 3, dims, PyArray_DescrFromType(NPY_FLOAT32));
+}
+
+/**
+ * respawns all agents and returns their observations, written to out if it is given.
+ * If seed is given, the games are seeded before, see VectorController::seed
+ */
+static PyObject* vector_reset(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *ptr = NULL;
+    PyObject *out = NULL;
+    PyObject *seedArg = Py_None;
+
+    static const char *kwlist[] = {"controller", "out", "seed", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|$OO", (char **) kwlist, &ptr, &out, &seedArg)) return NULL;
+
+    uint64_t seed = 0;
+    bool reseed = seedArg != Py_None;
+    if (reseed && !get_seed(seedArg, &seed)) return NULL;
+
+    VectorController *controller = (VectorController *) PyCapsule_GetPointer(ptr, vector_identifier);
+    if (controller == NULL) {
+        return NULL;
+    }
+
+    if (!check_no_pending_step(ptr)) return NULL;
+
+    PyArrayObject *observations = get_vector_observations(controller, out, "out");
+    if (observations == NULL) return NULL;
+
+    float *obsMemAddr = (float *) PyArray_DATA(observations);
+    BEGIN_NATIVE_CALL(controller)
+    if (reseed) controller->seed(seed);
+    controller->reset();
+    controller->getObservations(obsMemAddr);
+    END_NATIVE_CALL
+
+    return (PyObject *) observations;
+}
+
+/**
+ * returns (safe, danger), the uint8 action masks of all agents as arrays of
+ * shape (numEnvs, numAgents), see get_action_masks
+ */
+static PyObject* vector_action_masks(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *ptr = NULL;
+    PyObject *safeOut = NULL;
+    PyObject *dangerOut = NULL;
+
+    static const char *kwlist[] = {"controller", "safe_out", "danger_out", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|$OO", (char **) kwlist, &ptr, &safeOut, &dangerOut)) return NULL;
+
+    VectorController *controller = (VectorController *) PyCapsule_GetPointer(ptr, vector_identifier);
+    if (controller == NULL) {
+        return NULL;
+    }
+
+    if (!check_no_pending_step(ptr)) return NULL;
+
+    npy_intp dims[] = {controller->getNumEnvs(), controller->getNumAgents()};
+    PyArrayObject *safe = get_output_array(safeOut, "safe_out", 2, dims, PyArray_DescrFromType(NPY_UINT8));
+    PyArrayObject *danger = safe ? get_output_array(dangerOut, "danger_out", 2, dims, PyArray_DescrFromType(NPY_UINT8)) : NULL;
+    if (danger == NULL) {
+        Py_XDECREF(safe);
+        return NULL;
+    }
+
+    unsigned char *safeAddr = (unsigned char *) PyArray_DATA(safe);
+    unsigned char *dangerAddr = (unsigned char *) PyArray_DATA(danger);
+    BEGIN_NATIVE_CALL(controller)
+    controller->getActionMasks(safeAddr, dangerAddr);
+    END_NATIVE_CALL
+
+    return Py_BuildValue("NN", safe, danger);
+}
+
+/**
+ * returns the events of all games since their last step as structured
+ * array, see get_events. The field env holds the index of the game.
+ */
+static PyObject* vector_events(PyObject *self, PyObject *args)
+{
+    PyObject *ptr = NULL;
+
+    if (!PyArg_ParseTuple(args, "O", &ptr)) return NULL;
+
+    VectorController *controller = (VectorController *) PyCapsule_GetPointer(ptr, vector_identifier);
+    if (controller == NULL) {
+        return NULL;
+    }
+
+    if (!check_no_pending_step(ptr)) return NULL;
+
+    PyArray_Descr *descr = get_event_descr(true);
+    if (descr == NULL) return NULL;
+
+    lock_guard<mutex> controllerLock(controller->getMutex());
+
+    npy_intp dims[] = {controller->getNumEvents()};
+    PyArrayObject *arr = (PyArrayObject *) PyArray_NewFromDescr(&PyArray_Type, descr, 1, dims, NULL, NULL, 0, NULL);
+    if (arr == NULL) return NULL;
+
+    controller->getEvents((VectorEvent *) PyArray_DATA(arr));
+
+    return (PyObject *) arr;
+}
+
+/**
+ * parses the arguments of vector_step and step_async, and creates the
+ * arrays (actions, observations, rewards, dones, info) of the step.
+ * On success the controller, info fields and new references to the arrays are returned.
+ */
+static bool get_vector_step_arrays(PyObject *args, PyObject *kwargs, PyObject **capsule,
+                                   VectorController **controller, int *infoFields, PyArrayObject **arrays)
+{
+    PyObject *actionsArg = NULL;
+    PyObject *obsOut = NULL;
+    PyObject *rewardsOut = NULL;
+    PyObject *donesOut = NULL;
+    PyObject *infoOut = NULL;
+    *infoFields = INFO_ALL;
+
+    static const char *kwlist[] = {
+        "controller", "actions", "info_fields",
+        "obs_out", "rewards_out", "dones_out", "info_out", NULL
+    };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|$iOOOO", (char **) kwlist,
+        capsule, &actionsArg, infoFields, &obsOut, &rewardsOut, &donesOut, &infoOut)) {
+        return false;
+    }
+
+    if (!check_info_fields(*infoFields)) return false;
+
+    *controller = (VectorController *) PyCapsule_GetPointer(*capsule, vector_identifier);
+    if (*controller == NULL) {
+        return false;
+    }
+
+    if (!check_no_pending_step(*capsule)) return false;
+
+    npy_intp numEntries = (npy_intp) (*controller)->getNumEnvs() * (*controller)->getNumAgents();
+
+    PyArrayObject *actions = get_actions_array(actionsArg, numEntries, (*controller)->isActionSpaceDiscrete());
+    if (actions == NULL) return false;
+
+    npy_intp dims[] = {(*controller)->getNumEnvs(), (*controller)->getNumAgents()};
+    PyArrayObject *observations = get_vector_observations(*controller, obsOut, "obs_out");
+    PyArrayObject *rewards = observations ? get_output_array(rewardsOut, "rewards_out", 2, dims, PyArray_DescrFromType(NPY_FLOAT32)) : NULL;
+    PyArrayObject *dones = rewards ? get_output_array(donesOut, "dones_out", 2, dims, PyArray_DescrFromType(NPY_BOOL)) : NULL;
+    PyArrayObject *info = dones ? get_output_array(infoOut, "info_out", 2, dims, get_info_descr(*infoFields)) : NULL;
+
+    if (!info) {
+        Py_DECREF(actions);
+        Py_XDECREF(observations);
+        Py_XDECREF(rewards);
+        Py_XDECREF(dones);
+        return false;
+    }
+
+    arrays[0] = actions;
+    arrays[1] = observations;
+    arrays[2] = rewards;
+    arrays[3] = dones;
+    arrays[4] = info;
+    return true;
+}
+
+/**
+ * steps all environments with an array of shape (numEnvs, numAgents)
+ * returns (observations, rewards, dones, info), where info is a structured
+ * array of shape (numEnvs, numAgents) with the fields selected by info_fields.
+ * The results are written to obs_out, rewards_out, dones_out and info_out
+ * if they are given.
+ */
+static PyObject* vector_step(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *ptr = NULL;
+    VectorController *controller = NULL;
+    int infoFields;
+    PyArrayObject *arrays[5];
+
+    if (!get_vector_step_arrays(args, kwargs, &ptr, &controller, &infoFields, arrays)) return NULL;
+
+    PyArrayObject *actions = arrays[0];
+    float *obsAddr = (float *) PyArray_DATA(arrays[1]);
+    float *rewardsAddr = (float *) PyArray_DATA(arrays[2]);
+    bool *donesAddr = (bool *) PyArray_DATA(arrays[3]);
+    char *infoAddr = (char *) PyArray_DATA(arrays[4]);
+
+    BEGIN_NATIVE_CALL(controller)
+    with_typed_actions(actions, [&](auto *actionsAddr) {
+        controller->step(actionsAddr, obsAddr, rewardsAddr, donesAddr, infoFields, infoAddr);
+    });
+    END_NATIVE_CALL
+
+    Py_DECREF(actions);
+
+    return Py_BuildValue("NNNN", arrays[1], arrays[2], arrays[3], arrays[4]);
+}
+
+/**
+ * same arguments as vector_step, but the step runs on a background thread
+ * and the call returns immediately. step_wait returns its results.
+ * The actions and output arrays must not be modified until then.
+ */
+static PyObject* step_async(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *ptr = NULL;
+    VectorController *controller = NULL;
+    int infoFields;
+    PyArrayObject *arrays[5];
+
+    if (!get_vector_step_arrays(args, kwargs, &ptr, &controller, &infoFields, arrays)) return NULL;
+
+    PyObject *pending = Py_BuildValue("NNNNN", arrays[0], arrays[1], arrays[2], arrays[3], arrays[4]);
+    if (pending == NULL) return NULL;
+
+    if (PyCapsule_SetContext(ptr, pending) != 0) {
+        Py_DECREF(pending);
+        return NULL;
+    }
+
+    float *obsAddr = (float *) PyArray_DATA(arrays[1]);
+    float *rewardsAddr = (float *) PyArray_DATA(arrays[2]);
+    bool *donesAddr = (bool *) PyArray_DATA(arrays[3]);
+    char *infoAddr = (char *) PyArray_DATA(arrays[4]);
+
+    // the step takes the controller mutex on the background thread
+    with_typed_actions(arrays[0], [&](auto *actionsAddr) {
+        controller->stepAsync(actionsAddr, obsAddr, rewardsAddr, donesAddr, infoFields, infoAddr);
+    });
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * waits for the step started by step_async and returns (observations, rewards, dones, info)
+ */
+static PyObject* step_wait(PyObject *self, PyObject *args)
+{
+    PyObject *ptr = NULL;
+
+    if (!PyArg_ParseTuple(args, "O", &ptr)) return NULL;
+
+    VectorController *controller = (VectorController *) PyCapsule_GetPointer(ptr, vector_identifier);
+    if (controller == NULL) {
+        return NULL;
+    }
+
+    PyObject *pending = (PyObject *) PyCapsule_GetContext(ptr);
+    if (pending == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "no asynchronous step is pending, call step_async first");
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    controller->stepWait();
+    Py_END_ALLOW_THREADS
+
+    PyCapsule_SetContext(ptr, NULL);
+
+    PyObject *result = PyTuple_GetSlice(pending, 1, 5);
+    Py_DECREF(pending);
+    return result;
+}
+
+/**
+ * returns the structured dtype of the info records with the fields selected by info_fields
+ */
+static PyObject* info_dtype(PyObject *self, PyObject *args)
+{
+    int infoFields;
+
+    if (!PyArg_ParseTuple(args, "i", &infoFields)) return NULL;
+    if (!check_info_fields(infoFields)) return NULL;
+
+    return (PyObject *) get_info_descr(infoFields);
+}
+
+/**
+ * serves the environments of a vector controller to a client process through
+ * the shared memory segment shm_name and the unix socket at socket_path,
+ * see EnvServer. The controller holds the environments env_offset ..
+ * env_offset + its number of environments - 1 of the num_envs in the segment.
+ * Blocks without the GIL until the client closes the connection.
+ */
+static PyObject* serve(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *ptr = NULL;
+    const char *socketPath;
+    const char *shmName;
+    int numEnvs;
+    int envOffset;
+    int infoFields = INFO_ALL;
+    int numSlots = 2;
+
+    static const char *kwlist[] = {
+        "controller", "socket_path", "shm_name", "num_envs", "env_offset",
+        "info_fields", "num_slots", NULL
+    };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Ossii|$ii", (char **) kwlist,
+        &ptr, &socketPath, &shmName, &numEnvs, &envOffset, &infoFields, &numSlots)) {
+        return NULL;
+    }
+
+    if (!check_info_fields(infoFields)) return NULL;
+
+    if (numSlots < 1) {
+        PyErr_SetString(PyExc_ValueError, "num_slots must be positive");
+        return NULL;
+    }
+
+    VectorController *controller = (VectorController *) PyCapsule_GetPointer(ptr, vector_identifier);
+    if (controller == NULL) {
+        return NULL;
+    }
+
+    if (!check_no_pending_step(ptr)) return NULL;
+
+#ifdef _WIN32
+    PyErr_SetString(PyExc_NotImplementedError, "the environment server requires a POSIX system");
+    return NULL;
+#else
+    bool failed;
+
+    // serve locks the controller mutex for every command itself
+    Py_BEGIN_ALLOW_THREADS
+    EnvServer server(*controller, socketPath, shmName, numEnvs, envOffset, infoFields, numSlots);
+    failed = server.hasFailed();
+    server.serve();
+    Py_END_ALLOW_THREADS
+
+    if (failed) {
+        PyErr_SetString(PyExc_RuntimeError, "cannot start the environment server");
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+#endif
+}
+
+/**
+ * creates a tree search on the game of controller, see Mcts.
+ * The controller must have a discrete action space, rollout is a BOT_* type.
+ */
+static PyObject* setup_mcts(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *ptr = NULL;
+    int numThreads = 1;
+    int rolloutBot = BOT_RANDOM;
+    int rolloutDepth = 20;
+    float discount = 0.99;
+    float exploration = 1.4;
+    float virtualLoss = 1.0;
+    int batchSize = 16;
+    PyObject *seedArg = NULL;
+
+    static const char *kwlist[] = {
+        "controller",
+        "num_threads",
+        "rollout",
+        "rollout_depth",
+        "discount",
+        "exploration",
+        "virtual_loss",
+        "batch_size",
+        "seed",
+        NULL
+    };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|$iiifffiO", (char **) kwlist,
+        &ptr,
+        &numThreads,
+        &rolloutBot,
+        &rolloutDepth,
+        &discount,
+        &exploration,
+        &virtualLoss,
+        &batchSize,
+        &seedArg)) return NULL;
+
+    uint64_t seed;
+    if (!get_seed(seedArg, &seed)) return NULL;
+
+    Controller *controller = (Controller *) PyCapsule_GetPointer(ptr, identifier);
+    if (controller == NULL) {
+        return NULL;
+    }
+
+    if (!controller->isActionSpaceDiscrete()) {
+        PyErr_SetString(PyExc_ValueError, "the tree search needs a discrete action space");
+        return NULL;
+    }
+
+    if (rolloutBot < BOT_RANDOM || rolloutBot > BOT_DEFENSIVE) {
+        PyErr_SetString(PyExc_ValueError, "rollout must be one of the BOT_* types");
+        return NULL;
+    }
+
+    Mcts *mcts;
+    BEGIN_NATIVE_CALL(controller)
+    mcts = new Mcts(*controller, numThreads, rolloutBot, rolloutDepth, discount, exploration, virtualLoss,
+                    batchSize, seed);
+    END_NATIVE_CALL
+
+    PyObject *capsule = PyCapsule_New((void *) mcts, mcts_identifier, destroy_mcts);
+    if (capsule == NULL) {
+        delete mcts;
+        return NULL;
+    }
+
+    Py_INCREF(ptr);
+    PyCapsule_SetContext(capsule, ptr);
+
+    return capsule;
+}
+
+/**
+ * runs num_simulations simulations from the current state of the game for
+ * player_id and returns the visits and the mean returns of the 6 actions.
+ * evaluate is called with float32 observations of shape (n, observation size)
+ * and returns n values, without it the leaves are valued by rollouts only.
+ * The game of the controller is not changed.
+ */
+static PyObject* mcts_search(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *ptr = NULL;
+    int playerId;
+    int numSimulations;
+    PyObject *evaluate = Py_None;
+
+    static const char *kwlist[] = {"mcts", "player_id", "num_simulations", "evaluate", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oii|O", (char **) kwlist,
+        &ptr, &playerId, &numSimulations, &evaluate)) return NULL;
+
+    Mcts *mcts = (Mcts *) PyCapsule_GetPointer(ptr, mcts_identifier);
+    if (mcts == NULL) {
+        return NULL;
+    }
+
+    if (evaluate != Py_None && !PyCallable_Check(evaluate)) {
+        PyErr_SetString(PyExc_TypeError, "evaluate must be callable or None");
+        return NULL;
+    }
+
+    Controller *controller = (Controller *) PyCapsule_GetPointer((PyObject *) PyCapsule_GetContext(ptr), identifier);
+    if (controller == NULL) {
+        return NULL;
+    }
+
+    // a copy, the controller is not locked during the search
+    vector<char> state;
+    {
+        lock_guard<mutex> controllerLock(controller->getMutex());
+        const vector<char> &snapshot = controller->snapshot();
+        state.assign(snapshot.begin(), snapshot.end());
+    }
+
+    npy_intp dims[1] = {6};
+    PyArrayObject *visits = (PyArrayObject *) PyArray_SimpleNew(1, dims, NPY_INT32);
+    PyArrayObject *values = (PyArrayObject *) PyArray_SimpleNew(1, dims, NPY_FLOAT32);
+    if (visits == NULL || values == NULL) {
+        Py_XDECREF(visits);
+        Py_XDECREF(values);
+        return NULL;
+    }
+
+    long int observationSize = mcts->getObservationSize();
+
+    // runs without the GIL, takes it back for the python callback
+    Mcts::Evaluator evaluator;
+    if (evaluate != Py_None) {
+        evaluator = [evaluate, observationSize](const float *observations, int count, float *leafValues) {
+            PyGILState_STATE gilState = PyGILState_Ensure();
+            bool evaluated = false;
+
+            npy_intp obsDims[2] = {count, observationSize};
+            PyArrayObject *obs = (PyArrayObject *) PyArray_SimpleNew(2, obsDims, NPY_FLOAT32);
+
+            if (obs != NULL) {
+                copy_n(observations, count * observationSize, (float *) PyArray_DATA(obs));
+                PyObject *result = PyObject_CallFunctionObjArgs(evaluate, (PyObject *) obs, NULL);
+
+                if (result != NULL) {
+                    PyArrayObject *resultArray = (PyArrayObject *) PyArray_FROMANY(
+                        result, NPY_FLOAT32, 0, 0, NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST);
+
+                    if (resultArray != NULL && PyArray_SIZE(resultArray) != count) {
+                        PyErr_Format(PyExc_ValueError, "evaluate returned %ld values for %d observations",
+                                     (long) PyArray_SIZE(resultArray), count);
+                    } else if (resultArray != NULL) {
+                        copy_n((float *) PyArray_DATA(resultArray), count, leafValues);
+                        evaluated = true;
+                    }
+
+                    Py_XDECREF(resultArray);
+                    Py_DECREF(result);
+                }
+                Py_DECREF(obs);
+            }
+
+            PyGILState_Release(gilState);
+            return evaluated;
+        };
+    }
+
+    bool searched;
+    BEGIN_NATIVE_CALL(mcts)
+    searched = mcts->search(state.data(), state.size(), playerId, numSimulations, evaluator,
+                            (int *) PyArray_DATA(visits), (float *) PyArray_DATA(values));
+    END_NATIVE_CALL
+
+    if (!searched) {
+        Py_DECREF(visits);
+        Py_DECREF(values);
+
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, "the search failed, player_id must be an agent of the game");
+        }
+        return NULL;
+    }
+
+    return Py_BuildValue("NN", visits, values);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
 
 static PyMethodDef game_module_methods[] = { 
     {
-        "setup", setup, METH_VARARGS,
+        "setup", (PyCFunction)(void(*)(void)) setup, METH_VARARGS | METH_KEYWORDS,
         "calls constructor"
     },
     {
         "reset_player", reset_player, METH_VARARGS,
         "testing the reset player implementation"
     },
+    {
+        "reset_all", reset_all, METH_VARARGS,
+        "respawn all players"
+    },
+    {
+        "seed", seed, METH_VARARGS,
+        "seed the random numbers of a game"
+    },
+    {
+        "snapshot", snapshot, METH_VARARGS,
+        "returns the state of a game as bytes"
+    },
+    {
+        "restore", restore, METH_VARARGS,
+        "sets a game back to a snapshot"
+    },
     {
         "take_actions", take_actions, METH_VARARGS,
         "taking actions for all players"
     },
     {
-        "get_observation", get_observation, METH_VARARGS,
+        "step", (PyCFunction)(void(*)(void)) step, METH_VARARGS | METH_KEYWORDS,
+        "taking actions for all players, returns observations, rewards, dones and info"
+    },
+    {
+        "get_observation", (PyCFunction)(void(*)(void)) get_observation, METH_VARARGS | METH_KEYWORDS,
         "getting observation for a specific player"
     },
+    {
+        "get_observations", (PyCFunction)(void(*)(void)) get_observations, METH_VARARGS | METH_KEYWORDS,
+        "getting the observations of the first n players in one array"
+    },
+    {
+        "get_action_masks", (PyCFunction)(void(*)(void)) get_action_masks, METH_VARARGS | METH_KEYWORDS,
+        "getting the safe and dangerous actions of the first n players"
+    },
+    {
+        "get_events", get_events, METH_VARARGS,
+        "getting the events since the last step"
+    },
     {
         "is_dead", is_dead, METH_VARARGS,
         "check if one specific player is dead"
@@ -358,7 +1883,7 @@ static PyMethodDef game_module_methods[] = {
         "check if one specific player has captured the whole map"
     },
     {
-        "get_distances", get_distances, METH_VARARGS,
+        "get_distances", (PyCFunction)(void(*)(void)) get_distances, METH_VARARGS | METH_KEYWORDS,
         "get the distance from the border in each of the six directions"
     },
     {
@@ -373,10 +1898,62 @@ static PyMethodDef game_module_methods[] = {
         "get_num_claims", get_num_claims, METH_VARARGS,
         "get the number of claims a player currently has"
     },
+    {
+        "setup_vector", (PyCFunction)(void(*)(void)) setup_vector, METH_VARARGS | METH_KEYWORDS,
+        "creates a controller for a batch of environments"
+    },
+    {
+        "vector_reset", (PyCFunction)(void(*)(void)) vector_reset, METH_VARARGS | METH_KEYWORDS,
+        "respawns all agents of all environments"
+    },
+    {
+        "vector_action_masks", (PyCFunction)(void(*)(void)) vector_action_masks, METH_VARARGS | METH_KEYWORDS,
+        "getting the action masks of all agents of a batch"
+    },
+    {
+        "vector_events", vector_events, METH_VARARGS,
+        "getting the events of all environments of a batch since their last step"
+    },
+    {
+        "vector_step", (PyCFunction)(void(*)(void)) vector_step, METH_VARARGS | METH_KEYWORDS,
+        "steps all environments of a batch"
+    },
+    {
+        "step_async", (PyCFunction)(void(*)(void)) step_async, METH_VARARGS | METH_KEYWORDS,
+        "starts stepping all environments of a batch in the background"
+    },
+    {
+        "step_wait", step_wait, METH_VARARGS,
+        "waits for the step started by step_async and returns its results"
+    },
+    {
+        "info_dtype", info_dtype, METH_VARARGS,
+        "get the structured dtype of the info records"
+    },
+    {
+        "serve", (PyCFunction)(void(*)(void)) serve, METH_VARARGS | METH_KEYWORDS,
+        "serve the environments of a batch to another process through shared memory"
+    },
+    {
+        "setup_mcts", (PyCFunction)(void(*)(void)) setup_mcts, METH_VARARGS | METH_KEYWORDS,
+        "create a tree search on the game of a controller"
+    },
+    {
+        "mcts_search", (PyCFunction)(void(*)(void)) mcts_search, METH_VARARGS | METH_KEYWORDS,
+        "search the actions of a player, returns the visits and values of the actions"
+    },
     {
         "show", show, METH_VARARGS,
         "display current game on the screen"    
     },
+    {
+        "start_recording", (PyCFunction)(void(*)(void)) start_recording, METH_VARARGS | METH_KEYWORDS,
+        "record the demo view of every step to disk in the background"
+    },
+    {
+        "stop_recording", stop_recording, METH_VARARGS,
+        "finish the recording"
+    },
     {NULL, NULL, 0, NULL}
 };
 
@@ -398,5 +1975,41 @@ static struct PyModuleDef game_module_definition = {
 PyMODINIT_FUNC PyInit_game_module(void) {
     Py_Initialize();
     import_array();
-    return PyModule_Create(&game_module_definition);
+
+    PyObject *module = PyModule_Create(&game_module_definition);
+    if (module == NULL) return NULL;
+
+    // player slot types for the bots argument of setup
+    PyModule_AddIntConstant(module, "BOT_NONE", BOT_NONE);
+    PyModule_AddIntConstant(module, "BOT_RANDOM", BOT_RANDOM);
+    PyModule_AddIntConstant(module, "BOT_GRABBER", BOT_GRABBER);
+    PyModule_AddIntConstant(module, "BOT_HUNTER", BOT_HUNTER);
+    PyModule_AddIntConstant(module, "BOT_DEFENSIVE", BOT_DEFENSIVE);
+
+    // flags for the info_fields argument
+    PyModule_AddIntConstant(module, "INFO_KILLS", INFO_KILLS);
+    PyModule_AddIntConstant(module, "INFO_CAPTURES", INFO_CAPTURES);
+    PyModule_AddIntConstant(module, "INFO_CLAIMS", INFO_CLAIMS);
+    PyModule_AddIntConstant(module, "INFO_COVERAGE", INFO_COVERAGE);
+    PyModule_AddIntConstant(module, "INFO_WINNER", INFO_WINNER);
+    PyModule_AddIntConstant(module, "INFO_DEAD", INFO_DEAD);
+    PyModule_AddIntConstant(module, "INFO_DISTANCES", INFO_DISTANCES);
+    PyModule_AddIntConstant(module, "INFO_STEPS", INFO_STEPS);
+    PyModule_AddIntConstant(module, "INFO_RESET", INFO_RESET);
+    PyModule_AddIntConstant(module, "INFO_ALL", INFO_ALL);
+
+    PyModule_AddIntConstant(module, "EVENT_CLAIMED", EVENT_CLAIMED);
+    PyModule_AddIntConstant(module, "EVENT_CAPTURED", EVENT_CAPTURED);
+    PyModule_AddIntConstant(module, "EVENT_KILLED", EVENT_KILLED);
+    PyModule_AddIntConstant(module, "EVENT_DIED", EVENT_DIED);
+    PyModule_AddIntConstant(module, "EVENT_WON", EVENT_WON);
+
+    PyModule_AddIntConstant(module, "CAUSE_HEAD", CAUSE_HEAD);
+    PyModule_AddIntConstant(module, "CAUSE_SWAP", CAUSE_SWAP);
+    PyModule_AddIntConstant(module, "CAUSE_TAIL", CAUSE_TAIL);
+    PyModule_AddIntConstant(module, "CAUSE_SURROUNDED", CAUSE_SURROUNDED);
+    PyModule_AddIntConstant(module, "CAUSE_BORDER", CAUSE_BORDER);
+    PyModule_AddIntConstant(module, "CAUSE_SPAWN", CAUSE_SPAWN);
+
+    return module;
 }
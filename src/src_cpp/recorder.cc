@@ -0,0 +1,182 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include "include/recorder.h"
+
+using namespace std;
+
+
+Recorder::Recorder(Game &game, const string &path, int format, int width, int height, int queueSize) :
+    path(path),
+    format(format),
+    width(width),
+    height(height),
+    maxQueueSize(max(queueSize, 1)),
+    renderer(game, width, height),
+    stopping(false),
+    numWritten(0),
+    numDropped(0),
+    failed(false)
+{
+    if (format == RECORDING_Y4M) {
+        video.open(path, ios::out | ios::binary | ios::trunc);
+
+        if (!video.is_open()) {
+            cerr << "error: cannot open " << path << " for recording" << endl;
+            failed = true;
+            return;
+        }
+
+        video << "YUV4MPEG2 W" << width << " H" << height << " F" << RECORDING_FPS << ":1 Ip A1:1 C444\n";
+    }
+
+    writer = thread(&Recorder::writerLoop, this);
+}
+
+Recorder::~Recorder()
+{
+    close();
+}
+
+void Recorder::close()
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    frameAvailable.notify_one();
+
+    if (writer.joinable()) {
+        writer.join();
+    }
+
+    if (video.is_open()) {
+        video.close();
+    }
+}
+
+bool Recorder::isOpen()
+{
+    return !failed;
+}
+
+void Recorder::capture()
+{
+    if (failed) return;
+
+    vector<Uint8> frame;
+
+    {
+        lock_guard<mutex> lock(queueMutex);
+
+        if (stopping) return;
+
+        if (queue.size() >= maxQueueSize) {
+            numDropped++;
+            return;
+        }
+
+        // reuse the buffers of frames that were already written
+        if (!unusedFrames.empty()) {
+            frame = move(unusedFrames.back());
+            unusedFrames.pop_back();
+        }
+    }
+
+    frame.resize(width * height * 3);
+    renderer.render();
+    renderer.copyPixels(frame.data());
+
+    {
+        lock_guard<mutex> lock(queueMutex);
+        queue.push_back(move(frame));
+    }
+    frameAvailable.notify_one();
+}
+
+long Recorder::getNumWritten()
+{
+    lock_guard<mutex> lock(queueMutex);
+    return numWritten;
+}
+
+long Recorder::getNumDropped()
+{
+    lock_guard<mutex> lock(queueMutex);
+    return numDropped;
+}
+
+void Recorder::writerLoop()
+{
+    vector<Uint8> planes;
+
+    while (true) {
+        vector<Uint8> frame;
+
+        {
+            unique_lock<mutex> lock(queueMutex);
+            frameAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+
+            // the remaining frames are still written after stopping
+            if (queue.empty()) return;
+
+            frame = move(queue.front());
+            queue.pop_front();
+        }
+
+        writeFrame(frame, planes);
+
+        {
+            lock_guard<mutex> lock(queueMutex);
+            numWritten++;
+            unusedFrames.push_back(move(frame));
+        }
+    }
+}
+
+/**
+ * frame holds rgb bytes, planes is scratch memory for the yuv conversion
+ */
+void Recorder::writeFrame(const vector<Uint8> &frame, vector<Uint8> &planes)
+{
+    const int numPixels = width * height;
+
+    if (format == RECORDING_PPM) {
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "%06ld.ppm", numWritten);
+
+        ofstream image(path + suffix, ios::out | ios::binary | ios::trunc);
+        if (!image.is_open()) {
+            cerr << "error: cannot write frame " << path << suffix << endl;
+            return;
+        }
+
+        image << "P6\n" << width << " " << height << "\n255\n";
+        image.write((const char *) frame.data(), numPixels * 3);
+        return;
+    }
+
+    // full range bt.601 rgb -> yuv, one full resolution plane per channel
+    planes.resize(numPixels * 3);
+    Uint8 *yPlane = planes.data();
+    Uint8 *uPlane = yPlane + numPixels;
+    Uint8 *vPlane = uPlane + numPixels;
+
+    for (int i = 0; i < numPixels; i++) {
+        float r = frame[i * 3];
+        float g = frame[i * 3 + 1];
+        float b = frame[i * 3 + 2];
+
+        float y = 0.299f * r + 0.587f * g + 0.114f * b;
+        float u = 128.f - 0.168736f * r - 0.331264f * g + 0.5f * b;
+        float v = 128.f + 0.5f * r - 0.418688f * g - 0.081312f * b;
+
+        yPlane[i] = (Uint8) min(max(lround(y), 0L), 255L);
+        uPlane[i] = (Uint8) min(max(lround(u), 0L), 255L);
+        vPlane[i] = (Uint8) min(max(lround(v), 0L), 255L);
+    }
+
+    video << "FRAME\n";
+    video.write((const char *) planes.data(), numPixels * 3);
+}
@@ -1,8 +1,13 @@
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 #include "include/renderer.h"
 #include "include/utils.h"
 
+// defined in SDL2_gfxPrimitives.c but not declared in its header
+extern "C" int filledPolygonRGBAMT(SDL_Renderer *renderer, const Sint16 *vx, const Sint16 *vy, int n,
+                                   Uint8 r, Uint8 g, Uint8 b, Uint8 a, int **polyInts, int *polyAllocated);
+
 using namespace std;
 
 
@@ -15,6 +20,21 @@ const SDL_Color OBSERVATION_ENEMY_COLOR_LIGHT = lighten(OBSERVATION_ENEMY_COLOR,
 const SDL_Color OBSERVATION_ENEMY_COLOR_DARK1 = darken(OBSERVATION_ENEMY_COLOR);
 const SDL_Color OBSERVATION_ENEMY_COLOR_DARK2 = darken(OBSERVATION_ENEMY_COLOR, 0.4);
 
+// what a pixel of a semantic frame shows, stored in its red channel
+const Uint8 SEMANTIC_BACKGROUND = 0;
+const Uint8 SEMANTIC_FREE       = 1;
+const Uint8 SEMANTIC_BORDER     = 2;
+const Uint8 SEMANTIC_CAPTURE    = 3;
+const Uint8 SEMANTIC_CLAIM      = 4;
+const Uint8 SEMANTIC_PATH       = 5;
+const Uint8 SEMANTIC_POSITION   = 6;
+const int SEMANTIC_NUM_KINDS    = 7;
+
+SDL_Color semanticColor(Uint8 kind, int playerId)
+{
+    return SDL_Color{kind, (Uint8) playerId, 0, 255};
+}
+
 
 Renderer::Renderer(Game &game, int w, int h) : game(game)
 {
@@ -24,6 +44,9 @@ Renderer::Renderer(Game &game, int w, int h) : game(game)
     surface = nullptr;
     renderer = nullptr;
 
+    polyInts = nullptr;
+    polyAllocated = 0;
+
     // initialize with dummy values, later overwritten by setScale()
     scale = 1;
     tileRadiusScreen = 0;
@@ -34,7 +57,11 @@ Renderer::Renderer(Game &game, int w, int h) : game(game)
     setFocus(CartCoord{0, 0});
 }
 
-Renderer::~Renderer() = default;
+Renderer::~Renderer()
+{
+    // allocated by SDL2_gfx with malloc
+    free(polyInts);
+}
 
 int Renderer::getWidth()
 {
@@ -157,12 +184,62 @@ void Renderer::drawLines(vector<CartCoord> points, float w, SDL_Color color)
 
     for (unsigned long i = 1; i < points.size(); i++) {
         ScreenCoord c2 = transform(points[i]);
-        thickLineRGBA(renderer, c1.x, c1.y, c2.x, c2.y, lineWidth,
-                color.r, color.g, color.b, color.a);
+        drawThickLine(c1, c2, (Uint8) lineWidth, color);
         c1 = c2;
     }
 }
 
+/*
+ * same geometry as thickLineRGBA of SDL2_gfx, but the polygon is filled with
+ * the buffer of this renderer instead of the global one
+ */
+void Renderer::drawThickLine(ScreenCoord c1, ScreenCoord c2, Uint8 lineWidth, SDL_Color color)
+{
+    if (lineWidth < 1) return;
+
+    if (c1.x == c2.x && c1.y == c2.y) {
+        int wh = lineWidth / 2;
+        boxRGBA(renderer, c1.x - wh, c1.y - wh, c2.x + lineWidth, c2.y + lineWidth,
+                color.r, color.g, color.b, color.a);
+        return;
+    }
+
+    if (lineWidth == 1) {
+        lineRGBA(renderer, c1.x, c1.y, c2.x, c2.y, color.r, color.g, color.b, color.a);
+        return;
+    }
+
+    double dx = c2.x - c1.x;
+    double dy = c2.y - c1.y;
+    double l = sqrt(dx * dx + dy * dy);
+    double ang = atan2(dx, dy);
+    double adj = 0.1 + 0.9 * fabs(cos(2.0 * ang));
+    double wl2 = (lineWidth - adj) / (2.0 * l);
+    double nx = dx * wl2;
+    double ny = dy * wl2;
+
+    Sint16 vx[4] = {
+            (Sint16) (c1.x + ny),
+            (Sint16) (c1.x - ny),
+            (Sint16) (c2.x - ny),
+            (Sint16) (c2.x + ny)
+    };
+    Sint16 vy[4] = {
+            (Sint16) (c1.y - nx),
+            (Sint16) (c1.y + nx),
+            (Sint16) (c2.y + nx),
+            (Sint16) (c2.y - nx)
+    };
+
+    fillPolygon(vx, vy, 4, color);
+}
+
+void Renderer::fillPolygon(const Sint16 *vx, const Sint16 *vy, int n, SDL_Color color)
+{
+    filledPolygonRGBAMT(renderer, vx, vy, n, color.r, color.g, color.b, color.a,
+                        &polyInts, &polyAllocated);
+}
+
 void Renderer::drawCircle(CartCoord center, float radius, SDL_Color color)
 {
     ScreenCoord c = transform(center);
@@ -197,7 +274,7 @@ void Renderer::drawHexagon(CartCoord center, float radius, SDL_Color color)
             static_cast<Sint16>(y - r/2)
     };
 
-    filledPolygonRGBA(renderer, vx, vy, 6, color.r, color.g, color.b, color.a);
+    fillPolygon(vx, vy, 6, color);
 }
 
 void Renderer::drawTile(Tile tile, SDL_Color color)
@@ -223,7 +300,7 @@ void Renderer::drawTile(Tile tile, SDL_Color color)
     };
 
     SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-    filledPolygonRGBA(renderer, vx, vy, 6, color.r, color.g, color.b, color.a);
+    fillPolygon(vx, vy, 6, color);
 }
 
 ScreenCoord Renderer::transform(CartCoord c)
@@ -239,6 +316,74 @@ Sint16 Renderer::transform(float f)
     return (Sint16) round(f * scale);
 }
 
+/**
+ * draws the view of the demo window, which shows all players in their own colours
+ */
+void Renderer::renderDemoScene()
+{
+    SDL_SetRenderDrawColor(renderer,
+            COLOR_DEMO_BACKGROUND.r,
+            COLOR_DEMO_BACKGROUND.g,
+            COLOR_DEMO_BACKGROUND.b,
+            COLOR_DEMO_BACKGROUND.a);
+    SDL_RenderClear(renderer);
+
+    bool renderGrid = (game.getBoard().getRadius() < 20);
+
+    TileBoundingBox scope = getViewportBoundingBox();
+
+    for (int q = scope.min.q; q <= scope.max.q; q++) {
+        for (int r = scope.min.r; r <= scope.max.r; r++) {
+            Tile tile = Tile{q, r};
+
+            if (!game.getBoard().isValid(tile)) {
+                continue;
+            }
+
+            int ownerId = game.getBoard().getOwner(tile);
+
+            if (ownerId == BORDER_TILE) {
+                drawTile(tile, COLOR_RED);
+            } else if (renderGrid && ownerId == FREE_TILE) {
+                drawHexagon(hexToCart(tileToHex(tile)), 0.95, COLOR_WHITE);
+            } else if (ownerId >= 0) {
+                drawTile(tile, PLAYER_COLORS[ownerId]);
+            }
+        }
+    }
+
+    // determine which players are relevant for the current rendering viewport
+    vector<Player> playersToRender = vector<Player>{};
+    for (auto &player : game.getPlayers()) {
+        if (!player.isDead() && doIntersect(scope, player.getBoundingBox())) {
+            playersToRender.push_back(player);
+        }
+    }
+
+    // render the claimed territories
+    for (auto &player : playersToRender) {
+        SDL_Color color = lighten(PLAYER_COLORS[player.getId()], 0.7);
+        for (auto &tile : player.getClaim()) {
+            CartCoord center = hexToCart(tileToHex(tile));
+            drawHexagon(center, CLAIMED_TILE_UNIT_SIZE, color);
+        }
+    }
+
+    // render the paths
+    for (auto &player : playersToRender) {
+        SDL_Color color = PLAYER_COLORS[player.getId()];
+        drawLines(player.getPath(), PLAYER_PATH_WIDTH, darken(color));
+    }
+
+    // render the players themselves
+    for (auto &player : playersToRender) {
+        SDL_Color color = PLAYER_COLORS[player.getId()];
+        drawCircle(player.getPosition(), 1, darken(color, 0.3));
+    }
+
+    SDL_RenderPresent(renderer);
+}
+
 /*
  * #############################################################################################
  *
@@ -255,7 +400,9 @@ Sint16 Renderer::transform(float f)
  */
 DemoRenderer::DemoRenderer(Game &game, int width, int height) : Renderer(game, width, height)
 {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+    // the video subsystem is reference counted by SDL, so every demo
+    // window initializes and quits it on its own
+    if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0) {
         SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
     }
 
@@ -295,6 +442,8 @@ DemoRenderer::~DemoRenderer()
         SDL_DestroyWindow(window);
         window = nullptr;
     }
+
+    SDL_QuitSubSystem(SDL_INIT_VIDEO);
 }
 
 bool DemoRenderer::handleEvent(SDL_Event &e)
@@ -355,67 +504,7 @@ bool DemoRenderer::render()
     }
 
     // render the game
-    SDL_SetRenderDrawColor(renderer,
-            COLOR_DEMO_BACKGROUND.r,
-            COLOR_DEMO_BACKGROUND.g,
-            COLOR_DEMO_BACKGROUND.b,
-            COLOR_DEMO_BACKGROUND.a);
-    SDL_RenderClear(renderer);
-
-    bool renderGrid = (game.getBoard().getRadius() < 20);
-
-    TileBoundingBox scope = getViewportBoundingBox();
-
-    for (int q = scope.min.q; q <= scope.max.q; q++) {
-        for (int r = scope.min.r; r <= scope.max.r; r++) {
-            Tile tile = Tile{q, r};
-
-            if (!game.getBoard().isValid(tile)) {
-                continue;
-            }
-
-            int ownerId = game.getBoard().getOwner(tile);
-
-            if (ownerId == BORDER_TILE) {
-                drawTile(tile, COLOR_RED);
-            } else if (renderGrid && ownerId == FREE_TILE) {
-                drawHexagon(hexToCart(tileToHex(tile)), 0.95, COLOR_WHITE);
-            } else if (ownerId >= 0) {
-                drawTile(tile, PLAYER_COLORS[ownerId]);
-            }
-        }
-    }
-
-    // determine which players are relevant for the current rendering viewport
-    vector<Player> playersToRender = vector<Player>{};
-    for (auto &player : game.getPlayers()) {
-        if (!player.isDead() && doIntersect(scope, player.getBoundingBox())) {
-            playersToRender.push_back(player);
-        }
-    }
-
-    // render the claimed territories
-    for (auto &player : playersToRender) {
-        SDL_Color color = lighten(PLAYER_COLORS[player.getId()], 0.7);
-        for (auto &tile : player.getClaim()) {
-            CartCoord center = hexToCart(tileToHex(tile));
-            drawHexagon(center, CLAIMED_TILE_UNIT_SIZE, color);
-        }
-    }
-
-    // render the paths
-    for (auto &player : playersToRender) {
-        SDL_Color color = PLAYER_COLORS[player.getId()];
-        drawLines(player.getPath(), PLAYER_PATH_WIDTH, darken(color));
-    }
-
-    // render the players themselves
-    for (auto &player : playersToRender) {
-        SDL_Color color = PLAYER_COLORS[player.getId()];
-        drawCircle(player.getPosition(), 1, darken(color, 0.3));
-    }
-
-    SDL_RenderPresent(renderer);
+    renderDemoScene();
 
     return quit;
 }
@@ -428,13 +517,19 @@ bool DemoRenderer::render()
  * #############################################################################################
  * */
 
-ObservationRenderer::ObservationRenderer(Game &game, int width, int height) : Renderer(game, width, height)
+ObservationRenderer::ObservationRenderer(Game &game, int width, int height, int supersampling) : 
+    Renderer(game, width * supersampling, height * supersampling), 
+    supersampling(supersampling), 
+    outWidth(width), 
+    outHeight(height),
+    rowSums(width * 3)
 {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
-    }
+    // the observations are rendered in software to a plain surface,
+    // which works without initializing the SDL video subsystem
 
-    surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ABGR8888);
+    // RGBA32 keeps the byte order r, g, b, a in memory independent of
+    // the endianness, so writeTo() can read the channels directly
+    surface = SDL_CreateRGBSurfaceWithFormat(0, this->width, this->height, 32, SDL_PIXELFORMAT_RGBA32);
     renderer = SDL_CreateSoftwareRenderer(surface);
     SDL_RenderPresent(renderer);
 }
@@ -452,6 +547,14 @@ ObservationRenderer::~ObservationRenderer()
     }
 }
 
+/**
+ * the scale is given in output pixels per unit
+ */
+void ObservationRenderer::setScale(float s)
+{
+    Renderer::setScale(s * supersampling);
+}
+
 void ObservationRenderer::renderForPlayer(Player &player)
 {
     SDL_SetRenderDrawColor(renderer,
@@ -569,49 +672,264 @@ void ObservationRenderer::showOnly(CartCoord pos, int hexRadius)
 }
 
 
-Uint32 ObservationRenderer::getPixel(int x, int y)
+void ObservationRenderer::renderSemantic()
+{
+    SDL_Color background = semanticColor(SEMANTIC_BACKGROUND, 0);
+    SDL_SetRenderDrawColor(renderer, background.r, background.g, background.b, background.a);
+    SDL_RenderClear(renderer);
+
+    TileBoundingBox scope = getViewportBoundingBox();
+
+    for (int q = scope.min.q; q <= scope.max.q; q++) {
+        for (int r = scope.min.r; r <= scope.max.r; r++) {
+            Tile tile = Tile{q, r};
+
+            if (!game.getBoard().isValid(tile)) {
+                continue;
+            }
+
+            int ownerId = game.getBoard().getOwner(tile);
+
+            if (ownerId == BORDER_TILE) {
+                drawTile(tile, semanticColor(SEMANTIC_BORDER, 0));
+            } else if (ownerId == FREE_TILE) {
+                drawTile(tile, semanticColor(SEMANTIC_FREE, 0));
+            } else {
+                drawTile(tile, semanticColor(SEMANTIC_CAPTURE, ownerId));
+            }
+        }
+    }
+
+    // same layers as renderForPlayer, but every player is drawn in 
+    // the order of the ids instead of the observing player last
+    vector<Player *> playersToRender;
+    for (auto &p : game.getPlayers()) {
+        if (doIntersect(scope, p.getBoundingBox())) {
+            playersToRender.push_back(&p);
+        }
+    }
+
+    for (auto *p : playersToRender) {
+        for (auto &tile : p->getClaim()) {
+            CartCoord center = hexToCart(tileToHex(tile));
+            drawHexagon(center, CLAIMED_TILE_UNIT_SIZE, semanticColor(SEMANTIC_CLAIM, p->getId()));
+        }
+    }
+
+    for (auto *p : playersToRender) {
+        drawLines(p->getPath(), PLAYER_PATH_WIDTH, semanticColor(SEMANTIC_PATH, p->getId()));
+    }
+
+    for (auto *p : playersToRender) {
+        drawCircle(p->getPosition(), 1, semanticColor(SEMANTIC_POSITION, p->getId()));
+    }
+
+    SDL_RenderPresent(renderer);
+}
+
+void ObservationRenderer::writeFromSemantic(ObservationRenderer &semantic, Player &player, CartCoord pos, 
+                                            int hexRadius, float *obsMemAddr, ulong size)
 {
-    int bpp = surface->format->BytesPerPixel;
+    if (size != ((ulong)(outWidth * outHeight * 3))) {
+        cout << "error: given numpy array does provide a different size from what is required: " << size << endl;
+        return;
+    }
+
+    if (semantic.width != width || semantic.height != height || semantic.supersampling != supersampling) {
+        cout << "error: semantic frame does not match the size of the observation" << endl;
+        return;
+    }
 
-    /* Here p is the address to the pixel we want to retrieve */
-    Uint8 *p = (Uint8 *)surface->pixels + y * surface->pitch + x * bpp;
+    // colours of every kind of pixel, [kind][0] for the others, [kind][1] for the player
+    SDL_Color colors[SEMANTIC_NUM_KINDS][2] = {
+        {COLOR_DEMO_BACKGROUND, COLOR_DEMO_BACKGROUND},
+        {COLOR_WHITE, COLOR_WHITE},
+        {COLOR_RED, COLOR_RED},
+        {OBSERVATION_ENEMY_COLOR, OBSERVATION_PLAYER_COLOR},
+        {OBSERVATION_ENEMY_COLOR_LIGHT, OBSERVATION_PLAYER_COLOR_LIGHT},
+        {OBSERVATION_ENEMY_COLOR_DARK1, OBSERVATION_PLAYER_COLOR_DARK1},
+        {OBSERVATION_ENEMY_COLOR_DARK2, OBSERVATION_PLAYER_COLOR_DARK2}
+    };
 
-    switch (bpp) {
-        case 1:
-            return *p;
-        case 2:
-            return *(Uint16 *)p;
-        case 3:
-            if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-                return p[0] << 16 | p[1] << 8 | p[2];
-            else
-                return p[0] | p[1] << 8 | p[2] << 16;
-        case 4:
-            return *(Uint32 *)p;
-        default:
-            return 0;       /* shouldn't happen, but avoids warnings */
+    Uint32 palette[SEMANTIC_NUM_KINDS][2][3];
+    for (int kind = 0; kind < SEMANTIC_NUM_KINDS; kind++) {
+        for (int own = 0; own < 2; own++) {
+            palette[kind][own][0] = colors[kind][own].r;
+            palette[kind][own][1] = colors[kind][own].g;
+            palette[kind][own][2] = colors[kind][own].b;
+        }
+    }
+    const Uint32 *hidden = palette[SEMANTIC_BACKGROUND][0];
+
+    // the visible area, computed exactly like in showOnly
+    ScreenCoord c = semantic.transform(pos);
+    float dist = hexRadius * 1.5 * semantic.scale;
+    const int left = (int) (c.x - dist);
+    const int right = (int) (c.x + dist);
+    const int top = (int) (c.y - dist);
+    const int bottom = (int) (c.y + dist);
+
+    SDL_LockSurface(semantic.surface);
+
+    const auto *pixels = (const Uint8 *) semantic.surface->pixels;
+    const int pitch = semantic.surface->pitch;
+    const int rowLength = outWidth * 3;
+    const int ss = supersampling;
+    const float norm = 1.f / (float) (ss * ss);
+    const auto playerId = (Uint8) player.getId();
+    Uint32 *sums = rowSums.data();
+
+    for (int y = 0; y < outHeight; y++) {
+        fill(rowSums.begin(), rowSums.end(), 0);
+
+        for (int sy = 0; sy < ss; sy++) {
+            const int py = y * ss + sy;
+            const Uint8 *src = pixels + py * pitch;
+            const bool rowVisible = (py >= top && py < bottom);
+
+            for (int x = 0; x < outWidth; x++) {
+                for (int sx = 0; sx < ss; sx++) {
+                    const int px = x * ss + sx;
+                    const Uint32 *color = hidden;
+
+                    if (rowVisible && px >= left && px < right) {
+                        const Uint8 *label = src + px * 4;
+                        color = palette[label[0] < SEMANTIC_NUM_KINDS ? label[0] : 0][label[1] == playerId];
+                    }
+
+                    sums[x * 3] += color[0];
+                    sums[x * 3 + 1] += color[1];
+                    sums[x * 3 + 2] += color[2];
+                }
+            }
+        }
+
+        float *dst = obsMemAddr + y * rowLength;
+
+        for (int i = 0; i < rowLength; i++) {
+            dst[i] = (float) sums[i] * norm;
+        }
     }
+
+    SDL_UnlockSurface(semantic.surface);
 }
 
+/**
+ * copies the rendered image to obsMemAddr as rgb floats.
+ * With supersampling, each output pixel is the mean of its
+ * supersampling x supersampling block of surface pixels. The surface is
+ * walked once row by row, the inner loops run over contiguous bytes and
+ * get vectorized by the compiler.
+ */
 void ObservationRenderer::writeTo(float *obsMemAddr, ulong size)
 {
-    if (size != ((ulong)(width * height * 3))) {
+    if (size != ((ulong)(outWidth * outHeight * 3))) {
         cout << "error: given numpy array does provide a different size from what is required: " << size << endl;
         return;
     }
 
     SDL_LockSurface(surface);
 
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            Uint32 pixel = getPixel(x, y);
-            Uint8 r, g, b;
+    const auto *pixels = (const Uint8 *) surface->pixels;
+    const int pitch = surface->pitch;
+    const int rowLength = outWidth * 3;
+
+    if (supersampling == 1) {
+        for (int y = 0; y < outHeight; y++) {
+            const Uint8 *src = pixels + y * pitch;
+            float *dst = obsMemAddr + y * rowLength;
+
+            for (int x = 0; x < outWidth; x++) {
+                dst[x * 3] = (float) src[x * 4];
+                dst[x * 3 + 1] = (float) src[x * 4 + 1];
+                dst[x * 3 + 2] = (float) src[x * 4 + 2];
+            }
+        }
+
+        SDL_UnlockSurface(surface);
+        return;
+    }
+
+    const int ss = supersampling;
+    const float norm = 1.f / (float) (ss * ss);
+    Uint32 *sums = rowSums.data();
+
+    for (int y = 0; y < outHeight; y++) {
+        fill(rowSums.begin(), rowSums.end(), 0);
+
+        for (int sy = 0; sy < ss; sy++) {
+            const Uint8 *src = pixels + (y * ss + sy) * pitch;
+
+            for (int x = 0; x < outWidth; x++) {
+                const Uint8 *block = src + x * ss * 4;
+
+                for (int sx = 0; sx < ss; sx++) {
+                    sums[x * 3] += block[sx * 4];
+                    sums[x * 3 + 1] += block[sx * 4 + 1];
+                    sums[x * 3 + 2] += block[sx * 4 + 2];
+                }
+            }
+        }
+
+        float *dst = obsMemAddr + y * rowLength;
+
+        for (int i = 0; i < rowLength; i++) {
+            dst[i] = (float) sums[i] * norm;
+        }
+    }
+
+    SDL_UnlockSurface(surface);
+}
+
+
+/*
+ * #############################################################################################
+ *
+ *                                  Recording renderer starts here
+ *
+ * #############################################################################################
+ * */
+
+RecordingRenderer::RecordingRenderer(Game &game, int width, int height) : Renderer(game, width, height)
+{
+    surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    renderer = SDL_CreateSoftwareRenderer(surface);
+
+    // fit the whole arena into the frame
+    int extent = min(width, height);
+    setScale(((float) extent) / ((4 + 2 * game.getBoard().getRadius()) * 1.5));
+}
+
+RecordingRenderer::~RecordingRenderer()
+{
+    if (renderer != nullptr) {
+        SDL_DestroyRenderer(renderer);
+        renderer = nullptr;
+    }
 
-            SDL_GetRGB(pixel, surface->format, &r, &g, &b);
+    if (surface != nullptr) {
+        SDL_FreeSurface(surface);
+        surface = nullptr;
+    }
+}
 
-            obsMemAddr[(y * width + x) * 3] = (float) r;
-            obsMemAddr[(y * width + x) * 3 + 1] = (float) g;
-            obsMemAddr[(y * width + x) * 3 + 2] = (float) b;
+void RecordingRenderer::render()
+{
+    renderDemoScene();
+}
+
+void RecordingRenderer::copyPixels(Uint8 *dst)
+{
+    SDL_LockSurface(surface);
+
+    for (int y = 0; y < height; y++) {
+        const Uint8 *src = (const Uint8 *) surface->pixels + y * surface->pitch;
+        Uint8 *row = dst + y * width * 3;
+
+        for (int x = 0; x < width; x++) {
+            row[x * 3] = src[x * 4];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
         }
     }
 
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <algorithm>
+#include "include/thread_pool.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+
+ThreadPool::ThreadPool(int numThreads, bool pinThreads) : 
+    queues(max(numThreads, 1)), pinThreads(pinThreads),
+    task(nullptr), numBusy(0), generation(0), stopping(false)
+{
+    // the calling thread is worker 0, so only start the remaining ones
+    for (int i = 1; i < numThreads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(poolMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::getNumThreads()
+{
+    return workers.size() + 1;
+}
+
+void ThreadPool::parallelFor(int n, const function<void(int, int)> &fn)
+{
+    if (workers.empty() || n <= 1) {
+        for (int i = 0; i < n; i++) {
+            fn(i, 0);
+        }
+        return;
+    }
+
+    // one contiguous block of indices per worker, all workers are idle here
+    int numThreads = getNumThreads();
+    for (int w = 0; w < numThreads; w++) {
+        lock_guard<mutex> lock(queues[w].lock);
+        for (int i = (long) w * n / numThreads; i < (long) (w + 1) * n / numThreads; i++) {
+            queues[w].tasks.push_back(i);
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(poolMutex);
+        task = &fn;
+        numBusy = workers.size();
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    runTasks(0);
+
+    // wait until all workers have run out of tasks
+    unique_lock<mutex> lock(poolMutex);
+    finished.wait(lock, [this] { return numBusy == 0; });
+    task = nullptr;
+}
+
+/**
+ * tasks are only added before the workers are woken up, so once no 
+ * queue has a task left, this worker is done
+ */
+void ThreadPool::runTasks(int workerId)
+{
+    int i;
+    while (popTask(workerId, i) || stealTask(workerId, i)) {
+        (*task)(i, workerId);
+    }
+}
+
+bool ThreadPool::popTask(int workerId, int &index)
+{
+    WorkQueue &queue = queues[workerId];
+    lock_guard<mutex> lock(queue.lock);
+
+    if (queue.tasks.empty()) return false;
+
+    index = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::stealTask(int workerId, int &index)
+{
+    int numThreads = queues.size();
+
+    for (int offset = 1; offset < numThreads; offset++) {
+        WorkQueue &victim = queues[(workerId + offset) % numThreads];
+        lock_guard<mutex> lock(victim.lock);
+
+        if (victim.tasks.empty()) continue;
+
+        index = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+    }
+
+    return false;
+}
+
+void ThreadPool::pinToCore(int workerId)
+{
+#ifdef __linux__
+    int numCores = thread::hardware_concurrency();
+    if (numCores <= 0) return;
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(workerId % numCores, &cpuSet);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) != 0) {
+        cerr << "could not pin worker " << workerId << " to a core" << endl;
+    }
+#else
+    (void) workerId;
+#endif
+}
+
+void ThreadPool::workerLoop(int workerId)
+{
+    unsigned long seen = 0;
+
+    if (pinThreads) {
+        pinToCore(workerId);
+    }
+
+    while (true) {
+        {
+            unique_lock<mutex> lock(poolMutex);
+            wakeUp.wait(lock, [this, seen] { return stopping || generation != seen; });
+
+            if (stopping) return;
+            seen = generation;
+        }
+
+        runTasks(workerId);
+
+        {
+            lock_guard<mutex> lock(poolMutex);
+            numBusy--;
+        }
+        finished.notify_one();
+    }
+}
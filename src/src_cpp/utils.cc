@@ -56,6 +56,46 @@ Tile cartToTile(CartCoord c)
     return hexToTile(cartToHex(c));
 }
 
+FixedCoord cartToFixed(CartCoord c)
+{
+    return FixedCoord{(int32_t) lround(c.x * FIXED_ONE), (int32_t) lround(c.y * FIXED_ONE)};
+}
+
+CartCoord fixedToCart(FixedCoord c)
+{
+    return CartCoord{(float) c.x / FIXED_ONE, (float) c.y / FIXED_ONE};
+}
+
+Tile fixedToTile(FixedCoord c)
+{
+    // cartToHex with the factors in 2^-30 units, nothing is truncated before the rounding
+    const int64_t sqrt3By3 = 619925131;     // sqrt(3) / 3 * 2^30
+    const int64_t oneThird = 357913941;     // 1 / 3 * 2^30
+    const int shift = FIXED_SHIFT + 30;
+
+    int64_t q = sqrt3By3 * c.x - oneThird * c.y;
+    int64_t r = 2 * oneThird * c.y;
+    int64_t s = -q - r;
+
+    // cubeRound, the coordinate with the largest rounding error is derived from the others
+    const int64_t one = (int64_t) 1 << shift;
+    int64_t rq = (q + one / 2) >> shift;
+    int64_t rr = (r + one / 2) >> shift;
+    int64_t rs = (s + one / 2) >> shift;
+
+    int64_t dq = llabs(rq * one - q);
+    int64_t dr = llabs(rr * one - r);
+    int64_t ds = llabs(rs * one - s);
+
+    if (dq > ds && dq > dr) {
+        rq = -rs - rr;
+    } else if (ds <= dr) {
+        rr = -rq - rs;
+    }
+
+    return Tile{(int) rq, (int) rr};
+}
+
 CubeCoord cubeRound(CubeCoord c)
 {
     float rx = round(c.x);
@@ -156,6 +196,7 @@ bool doIntersect(TileBoundingBox a, TileBoundingBox b)
              a.min.r > b.max.r);
 }
 
+#ifndef HEXARIO_HEADLESS
 SDL_Color lighten(SDL_Color color, float percentage)
 {
     auto val = (Uint8) (255. * percentage);
@@ -172,4 +213,5 @@ SDL_Color darken(SDL_Color color, float percentage)
     Uint8 g = max(color.g - val, 0);
     Uint8 b = max(color.b - val, 0);
     return SDL_Color{r, g, b, 255};
-}
\ No newline at end of file
+}
+#endif //HEXARIO_HEADLESS
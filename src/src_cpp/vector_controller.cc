@@ -0,0 +1,219 @@
+#include <iostream>
+#include <algorithm>
+#include "include/vector_controller.h"
+
+using namespace std;
+
+
+VectorController::VectorController(
+        int numEnvs,
+        int numAgents,
+        int mapRadius,
+        bool localPerspective,
+        bool featureObservations,
+        bool discreteActionSpace,
+        int observationRadius,
+        int pxObservationWidth,
+        int pxObservationHeight,
+        float defaultVelocity,
+        int pxSupersampling,
+        bool sharedGlobalRender,
+        RewardWeights rewardWeights,
+        int maxSteps,
+        int numThreads,
+        bool pinThreads,
+        uint64_t seed,
+        int numHeadings
+        ) :
+    numEnvs(numEnvs),
+    numAgents(numAgents),
+    observationSize(featureObservations
+        ? (localPerspective ? 1 + 3 * observationRadius * (observationRadius - 1) : 1 + 3 * mapRadius * (mapRadius - 1))
+        : (long int) pxObservationWidth * pxObservationHeight * 3),
+    pool(numThreads, pinThreads),
+    stopping(false)
+{
+    for (int i = 0; i < numEnvs; i++) {
+        envs.push_back(new Controller(
+            mapRadius,
+            numAgents,
+            localPerspective,
+            featureObservations,
+            discreteActionSpace,
+            observationRadius,
+            pxObservationWidth,
+            pxObservationHeight,
+            defaultVelocity,
+            pxSupersampling,
+            1,
+            sharedGlobalRender,
+            rewardWeights,
+            maxSteps,
+            true,
+            vector<int>(),
+            seed + i,
+            numHeadings
+        ));
+    }
+}
+
+VectorController::~VectorController()
+{
+    // a pending step is completed first
+    {
+        lock_guard<mutex> lock(asyncMutex);
+        stopping = true;
+    }
+    asyncChanged.notify_all();
+
+    if (stepper.joinable()) {
+        stepper.join();
+    }
+
+    for (auto *env : envs) {
+        delete env;
+    }
+}
+
+int VectorController::getNumEnvs()
+{
+    return numEnvs;
+}
+
+int VectorController::getNumAgents()
+{
+    return numAgents;
+}
+
+long int VectorController::getObservationSize()
+{
+    return observationSize;
+}
+
+bool VectorController::isActionSpaceDiscrete()
+{
+    return envs[0]->isActionSpaceDiscrete();
+}
+
+void VectorController::reset()
+{
+    pool.parallelFor(numEnvs, [this](int env, int workerId) {
+        envs[env]->resetAll();
+    });
+}
+
+void VectorController::seed(uint64_t seed)
+{
+    for (int i = 0; i < numEnvs; i++) {
+        envs[i]->seed(seed + i);
+    }
+}
+
+template<typename T>
+void VectorController::step(const T *actions, float *observations, float *rewards, bool *dones,
+                            int infoFields, char *info)
+{
+    // every game is written to its own slice of the arrays, 
+    // parallelFor returns once all of them are complete
+    pool.parallelFor(numEnvs, [&](int env, int workerId) {
+        int offset = env * numAgents;
+
+        envs[env]->step(actions + offset, rewards + offset, dones + offset,
+                        infoFields, info + offset * Controller::getInfoRecordSize(infoFields));
+
+        envs[env]->getObservations(numAgents, observations + offset * observationSize,
+                                   numAgents * observationSize);
+    });
+}
+
+template<typename T>
+void VectorController::stepAsync(const T *actions, float *observations, float *rewards, bool *dones,
+                                 int infoFields, char *info)
+{
+    {
+        lock_guard<mutex> lock(asyncMutex);
+
+        asyncStep = [=]() {
+            lock_guard<mutex> callLock(callMutex);
+            step(actions, observations, rewards, dones, infoFields, info);
+        };
+
+        // the thread is only started by the first asynchronous step
+        if (!stepper.joinable()) {
+            stepper = thread(&VectorController::stepperLoop, this);
+        }
+    }
+    asyncChanged.notify_all();
+}
+
+void VectorController::stepWait()
+{
+    unique_lock<mutex> lock(asyncMutex);
+    asyncChanged.wait(lock, [this] { return !asyncStep; });
+}
+
+void VectorController::stepperLoop()
+{
+    unique_lock<mutex> lock(asyncMutex);
+
+    while (true) {
+        asyncChanged.wait(lock, [this] { return stopping || asyncStep; });
+
+        if (!asyncStep) return;
+
+        function<void()> job = asyncStep;
+        lock.unlock();
+        job();
+        lock.lock();
+
+        asyncStep = nullptr;
+        asyncChanged.notify_all();
+    }
+}
+
+std::mutex &VectorController::getMutex()
+{
+    return callMutex;
+}
+
+void VectorController::getObservations(float *observations)
+{
+    pool.parallelFor(numEnvs, [&](int env, int workerId) {
+        envs[env]->getObservations(numAgents, observations + env * numAgents * observationSize,
+                                   numAgents * observationSize);
+    });
+}
+
+void VectorController::getActionMasks(unsigned char *safe, unsigned char *danger)
+{
+    pool.parallelFor(numEnvs, [&](int env, int workerId) {
+        envs[env]->getActionMasks(numAgents, safe + env * numAgents, danger + env * numAgents);
+    });
+}
+
+long int VectorController::getNumEvents()
+{
+    long int numEvents = 0;
+
+    for (auto *env : envs) {
+        numEvents += env->getGame().getEvents().size();
+    }
+
+    return numEvents;
+}
+
+void VectorController::getEvents(VectorEvent *events)
+{
+    for (int i = 0; i < numEnvs; i++) {
+        for (auto &event : envs[i]->getGame().getEvents()) {
+            *events++ = VectorEvent{i, event};
+        }
+    }
+}
+
+#define INSTANTIATE_STEP(T) \
+    template void VectorController::step<T>(const T *actions, float *observations, float *rewards, \
+                                            bool *dones, int infoFields, char *info); \
+    template void VectorController::stepAsync<T>(const T *actions, float *observations, float *rewards, \
+                                                 bool *dones, int infoFields, char *info);
+FOR_EACH_ACTION_TYPE(INSTANTIATE_STEP)